@@ -14,20 +14,64 @@
  * limitations under the License.
  */
 
+#include <android-base/file.h>
+#include <android-base/properties.h>
 #include <android-base/stringprintf.h>
+#include <android-base/strings.h>
 #include <batteryservice/BatteryService.h>
 #include <cutils/klog.h>
 #include <math.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/eventfd.h>
+
+#include <algorithm>
+#include <chrono>
 
 #include "healthd_draw.h"
+#include "healthd_draw_gradient.h"
+#include "healthd_draw_log.h"
+#include "healthd_draw_raster.h"
 
 #if !defined(__ANDROID_VNDK__)
 #include "charger.sysprop.h"
 #endif
 
-#define LOGE(x...) KLOG_ERROR("charger", x);
-#define LOGW(x...) KLOG_WARNING("charger", x);
-#define LOGV(x...) KLOG_DEBUG("charger", x);
+#define LOGE(x...) HEALTHD_DRAW_LOG(KLOG_ERROR_LEVEL, x)
+#define LOGW(x...) HEALTHD_DRAW_LOG(KLOG_WARNING_LEVEL, x)
+#define LOGI(x...) HEALTHD_DRAW_LOG(KLOG_INFO_LEVEL, x)
+#define LOGV(x...) HEALTHD_DRAW_LOG(KLOG_DEBUG_LEVEL, x)
+
+// Cap on memory for decoded battery animation frames, in KiB.
+static constexpr char kFrameBudgetProperty[] = "ro.charger.frame_budget_kb";
+static constexpr int kDefaultFrameBudgetKb = 4096;
+
+// Compose frames in RGB565 and expand them to the framebuffer format only when
+// presenting, halving the bytes drawn and cached.
+static constexpr char kRgb565Property[] = "ro.charger.render_rgb565";
+
+// Threads composing each frame in horizontal bands, the drawing thread
+// included; 0 picks one per CPU. Frames are then composed offscreen.
+static constexpr char kRenderThreadsProperty[] = "ro.charger.render_threads";
+
+// Texts of the unknown-status screen, drawn in the system font.
+static constexpr const char* kUnknownTexts[] = {"Charging!", "?\?/100"};
+
+// Path prefix for frame profile dumps; see HealthdDraw::request_profile_dump().
+static constexpr char kProfilePathProperty[] = "debug.charger.frame_profile";
+static volatile sig_atomic_t profile_dump_requested = 0;
+
+// Formatted lengths of the clock's "%H:%M" and the date's "%d/%m/%Y".
+static constexpr int kClockTextLength = 5;
+static constexpr int kDateTextLength = 10;
+// The clock, date and charge texts as laid out, each digit standing for any.
+static constexpr char kClockTextSample[] = "00:00";
+static constexpr char kDateTextSample[] = "00/00/0000";
+static constexpr char kChargeTextSample[] = "000%/h 00h00";
+static_assert(sizeof(kClockTextSample) == kClockTextLength + 1 &&
+                      sizeof(kDateTextSample) == kDateTextLength + 1 &&
+                      sizeof(kChargeTextSample) == ChargeRateEstimator::kTextLength + 1,
+              "samples must be as long as the texts");
 
 static bool get_split_screen() {
 #if !defined(__ANDROID_VNDK__)
@@ -56,377 +100,1634 @@ static int get_split_offset() {
     return static_cast<int>(value);
 }
 
-HealthdDraw::HealthdDraw(animation* anim)
-    : kSplitScreen(get_split_screen()), kSplitOffset(get_split_offset()) {
+static int get_render_threads() {
+    int threads = base::GetIntProperty(kRenderThreadsProperty, 1, 0, INT_MAX);
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return std::max(threads, 1);
+}
+
+// HealthdDrawBackend drawing with minui, as used on device.
+class MinuiDrawBackend : public HealthdDrawBackend {
+  public:
+    int width() override { return gr_fb_width(); }
+    int height() override { return gr_fb_height(); }
+    PixelFormat pixel_format() override { return gr_pixel_format(); }
+    bool split_screen() override { return get_split_screen(); }
+    int split_offset() override { return get_split_offset(); }
+    int render_threads() override { return get_render_threads(); }
+
+    const GRFont* sys_font() override { return gr_sys_font(); }
+    int init_font(const char* name, GRFont** dest) override { return gr_init_font(name, dest); }
+    int measure(const GRFont* font, const char* str) override { return gr_measure(font, str); }
+    void color(unsigned char r, unsigned char g, unsigned char b, unsigned char a) override {
+        gr_color(r, g, b, a);
+    }
+    void clear() override { gr_clear(); }
+    void fill(int x1, int y1, int x2, int y2) override { gr_fill(x1, y1, x2, y2); }
+    void text(const GRFont* font, int x, int y, const char* str, bool bold) override {
+        gr_text(font, x, y, str, bold);
+    }
+    void text_mask(const GRSurface* mask, int x, int y) override { gr_texticon(x, y, mask); }
+    void blit(const GRSurface* source, int sx, int sy, int w, int h, int dx, int dy) override {
+        if (source->pixel_bytes != 2) {
+            gr_blit(source, sx, sy, w, h, dx, dy);
+            return;
+        }
+        // minui only blits surfaces in its own format, so RGB565 is expanded a
+        // band of rows at a time.
+        if (!convert_ || static_cast<int>(convert_->width) < w) {
+            convert_ = raster_create(std::max(w, gr_fb_width()), kConvertRows);
+            if (!convert_) return;
+        }
+        for (int row = 0; row < h; row += kConvertRows) {
+            int rows = std::min(h - row, kConvertRows);
+            raster_blit_convert(convert_.get(), source, gr_pixel_format(), sx, sy + row, w, rows,
+                                0, 0, false /* dither */);
+            gr_blit(convert_.get(), 0, 0, w, rows, dx, dy + row);
+        }
+    }
+
+    // minui has no partial-update entry point yet, so the whole frame is flipped.
+    void flip(const std::vector<DrawRect>& /* damage */) override { gr_flip(); }
+    void blank(bool blank, int drm) override {
+        gr_fb_blank(blank, drm);
+        if (!blank) active_connector_ = drm;
+    }
+    void rotate(GRRotation rotation) override { gr_rotate(rotation); }
+    bool has_multiple_connectors() override { return gr_has_multiple_connectors(); }
+    // minui draws to and flips only the connector last unblanked.
+    bool select_connector(int drm) override { return drm == active_connector_; }
+
+  private:
+    static constexpr int kConvertRows = 32;
+
+    int active_connector_ = 0;
+    // Staging rows for RGB565 blits.
+    std::unique_ptr<GRSurface> convert_;
+};
+
+// Screen descriptions listing the battery screen's elements, as lines of
+// "element: ..." (see healthd_draw_elements.h), and optionally a custom percent
+// color ramp, as lines of "percent_gradient: <level> <r> <g> <b>" (see
+// healthd_draw_gradient.h). They sit next to the animation description, whose
+// parser rejects any line it does not know; in order of preference.
+static constexpr const char* kScreenDescPaths[] = {
+        "/product/etc/res/values/charger/elements.txt",
+        "/res/values/charger/elements.txt",
+};
+static constexpr size_t kMaxGradientStops = 32;
+static constexpr size_t kMaxScreenElements = 16;
+
+// Reads the first screen description found into |content| and returns its
+// path, or nullptr if there is none.
+static const char* read_screen_desc(std::string* content) {
+    for (const char* candidate : kScreenDescPaths) {
+        if (base::ReadFileToString(candidate, content)) return candidate;
+    }
+    return nullptr;
+}
+
+// Bakes the custom percent ramp from the screen description into |lut|.
+// Returns false, leaving |lut| untouched, if there is none or it is invalid.
+static bool load_percent_gradient(GradientLut* lut) {
+    std::string content;
+    const char* path = read_screen_desc(&content);
+    if (path == nullptr) return false;
+
+    GradientStop stops[kMaxGradientStops];
+    size_t count = 0;
+    for (const std::string& line : base::Split(content, "\n")) {
+        std::string trimmed = base::Trim(line);
+        if (!base::StartsWith(trimmed, "percent_gradient:")) continue;
+        int level, r, g, b;
+        if (sscanf(trimmed.c_str(), "percent_gradient: %d %d %d %d", &level, &r, &g, &b) != 4 ||
+            r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255) {
+            LOGE("%s: bad percent_gradient line '%s'\n", path, trimmed.c_str());
+            return false;
+        }
+        if (count == kMaxGradientStops) {
+            LOGE("%s: more than %zu percent_gradient stops\n", path, kMaxGradientStops);
+            return false;
+        }
+        stops[count++] = {level, static_cast<uint8_t>(r), static_cast<uint8_t>(g),
+                          static_cast<uint8_t>(b)};
+    }
+    if (count == 0) return false;
+    if (!gradient_stops_valid(stops, count)) {
+        LOGE("%s: percent_gradient must increase from 0 to 100\n", path);
+        return false;
+    }
+    *lut = make_gradient_lut(stops, count);
+    LOGV("%s: loaded %zu percent_gradient stops\n", path, count);
+    return true;
+}
+
+// Reads the screen elements from the screen description into |elements|.
+// Falls back to kDefaultScreenElements if there are none or any is invalid.
+static void load_screen_elements(std::vector<ScreenElement>* elements) {
+    elements->clear();
+    std::string content;
+    const char* path = read_screen_desc(&content);
+    if (path != nullptr) {
+        for (const std::string& line : base::Split(content, "\n")) {
+            std::string trimmed = base::Trim(line);
+            if (!base::StartsWith(trimmed, "element:")) continue;
+            ScreenElement element;
+            if (elements->size() == kMaxScreenElements) {
+                LOGE("%s: more than %zu elements\n", path, kMaxScreenElements);
+            } else if (parse_screen_element(trimmed.c_str() + strlen("element:"), &element)) {
+                elements->push_back(element);
+                continue;
+            } else {
+                LOGE("%s: bad element line '%s'\n", path, trimmed.c_str());
+            }
+            elements->clear();
+            break;
+        }
+        if (!elements->empty()) {
+            LOGV("%s: loaded %zu screen elements\n", path, elements->size());
+            return;
+        }
+    }
+    for (const char* spec : kDefaultScreenElements) {
+        ScreenElement element;
+        if (parse_screen_element(spec, &element)) elements->push_back(element);
+    }
+}
+
+static int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+static void profile_signal_handler(int /* signal */) {
+    HealthdDraw::request_profile_dump();
+}
+
+// SIGUSR1 asks for a frame profile dump, in builds that profile, unless the
+// process already handles or ignores it.
+static void install_profile_signal() {
+    if (!HEALTHD_DRAW_PROFILING) return;
+    struct sigaction old = {};
+    if (sigaction(SIGUSR1, nullptr, &old) < 0 || (old.sa_flags & SA_SIGINFO) ||
+        old.sa_handler != SIG_DFL) {
+        return;
+    }
+    struct sigaction action = {};
+    action.sa_handler = profile_signal_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR1, &action, nullptr) == 0) {
+        LOGI("charger frame profile dumped on SIGUSR1\n");
+    }
+}
+
+static size_t get_frame_budget() {
+    int kb = base::GetIntProperty(kFrameBudgetProperty, kDefaultFrameBudgetKb, 0, INT_MAX / 1024);
+    return static_cast<size_t>(kb) * 1024;
+}
+
+HealthdDraw::HealthdDraw(animation* anim, std::unique_ptr<HealthdDrawBackend> backend)
+    : frame_store_(get_frame_budget()),
+      kSplitScreen(backend->split_screen()),
+      kSplitOffset(backend->split_offset()),
+      kRgb565(base::GetBoolProperty(kRgb565Property, false)),
+      kRenderThreads(std::clamp(backend->render_threads(), 1, kMaxRenderThreads)),
+      backend_(std::move(backend)),
+      created_ns_(steady_now_ns()) {
     graphics_available = true;
-    sys_font = gr_sys_font();
+    sys_font = backend_->sys_font();
     if (sys_font == nullptr) {
         LOGW("No system font, screen fallback text not available\n");
     } else {
-        gr_font_size(sys_font, &char_width_, &char_height_);
+        char_width_ = sys_font->char_width;
+        char_height_ = sys_font->char_height;
     }
 
-    screen_width_ = gr_fb_width() / (kSplitScreen ? 2 : 1);
-    screen_height_ = gr_fb_height();
+    num_displays_ = std::clamp(backend_->connector_count(), 1, kMaxConnectors);
+    for (int drm = 0; drm < num_displays_; drm++) {
+        displays_[drm].drm = drm;
+        // Only the main connector is lit until the charger unblanks another.
+        displays_[drm].blanked = drm > 0;
+        if (drm > 0) blanked_mask_ |= 1u << drm;
+
+        Display& display = displays_[drm];
+        display.frame_ops.reserve(kMaxFrameOps);
+        display.last_ops.reserve(kMaxFrameOps);
+        display.parked.last_ops.reserve(kMaxFrameOps);
+        // add_damage() holds one rectangle over the limit before collapsing.
+        display.damage.reserve(kMaxDamageRects + 1);
+        display.own_damage.reserve(kMaxDamageRects + 1);
+        for (std::vector<DrawRect>& older : display.damage_history) {
+            older.reserve(kMaxDamageRects + 1);
+        }
+        // The whole screen, plus both split-screen copies of each rectangle.
+        display.present_damage.reserve(2 * (kMaxDamageRects + 1) + 1);
+    }
 
-    int res;
-    if (!anim->text_clock.font_file.empty() &&
-        (res = gr_init_font(anim->text_clock.font_file.c_str(), &anim->text_clock.font)) < 0) {
-        LOGE("Could not load time font (%d)\n", res);
+    glyph_runs_.set_measure(&HealthdDraw::measure_run, this);
+    install_profile_signal();
+
+    // Decoding font PNGs is kept off the path to the first frame.
+    start_font_loading(anim);
+
+    percent_gradient_ = kDefaultGradientLut;
+    load_percent_gradient(&percent_gradient_);
+    load_screen_elements(&screen_elements_);
+
+    if (kRgb565) {
+        LOGI("charger composing in RGB565%s\n",
+             backend_->native_rgb565() ? "" : ", converted when presenting");
+        frame_store_.set_rgb565(backend_->pixel_format());
+    }
+    if (kRenderThreads > 1) LOGI("charger composing frames on %d threads\n", kRenderThreads);
+    adopt_animation_frames(anim);
+}
+
+HealthdDraw::~HealthdDraw() {
+    stop_render_thread();
+    stop_paint_helper();
+    if (font_thread_.joinable()) font_thread_.join();
+    ChargerLog::get().flush();
+}
+
+void HealthdDraw::start_font_loading(const animation* anim) {
+    const std::string names[FONT_COUNT] = {anim->text_clock.font_file,
+                                           anim->text_percent.font_file};
+    bool decode = false;
+    for (int slot = 0; slot < FONT_COUNT; slot++) {
+        if (names[slot].empty()) continue;
+        // A cache is only trusted once the chunk CRCs of the PNG it stands for
+        // match it, which reads a few bytes per chunk; without one the font is
+        // decoded, or fails to load, as usual.
+        GlyphCacheSource source;
+        if (read_glyph_cache_source(font_png_path(names[slot]), &source)) {
+            mapped_fonts_[slot] =
+                    MappedGlyphFont::Map(glyph_cache_path(kGlyphCacheDir, names[slot]), source);
+        }
+        if (mapped_fonts_[slot]) {
+            loaded_fonts_[slot] = mapped_fonts_[slot]->font();
+            startup_stats_.fonts_from_cache++;
+        } else {
+            decode = true;
+        }
     }
-    if (!anim->text_percent.font_file.empty() &&
-        (res = gr_init_font(anim->text_percent.font_file.c_str(), &anim->text_percent.font)) < 0) {
-        LOGE("Could not load percent font (%d)\n", res);
+    if (!decode) {
+        fonts_ready_ = true;
+        return;
     }
+    font_event_fd_.reset(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+    font_thread_ = std::thread([this, names] { load_fonts(names); });
 }
 
-HealthdDraw::~HealthdDraw() {}
+void HealthdDraw::load_fonts(const std::string (&names)[FONT_COUNT]) {
+    static constexpr const char* kFontNames[FONT_COUNT] = {"time", "percent"};
+    for (int slot = 0; slot < FONT_COUNT; slot++) {
+        if (names[slot].empty() || loaded_fonts_[slot] != nullptr) continue;
+        GRFont* font = nullptr;
+        int res = backend_->init_font(names[slot].c_str(), &font);
+        if (res < 0) {
+            LOGE("Could not load %s font (%d)\n", kFontNames[slot], res);
+            continue;
+        }
+        loaded_fonts_[slot] = font;
+    }
+    fonts_ready_.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    if (font_event_fd_.get() >= 0) {
+        (void)TEMP_FAILURE_RETRY(write(font_event_fd_.get(), &one, sizeof(one)));
+    }
+}
+
+void HealthdDraw::resolve_fonts(const animation* anim) {
+    if (!fonts_adopted_ && fonts_ready_.load(std::memory_order_acquire)) {
+        if (font_thread_.joinable()) font_thread_.join();
+        fonts_adopted_ = true;
+        int64_t ready_ns = steady_now_ns() - created_ns_;
+        int from_cache;
+        {
+            std::lock_guard<std::mutex> lock(startup_mutex_);
+            startup_stats_.fonts_ready_ns = ready_ns;
+            from_cache = startup_stats_.fonts_from_cache;
+        }
+        LOGI("charger fonts ready after %lld ms, %d from cache\n",
+             static_cast<long long>(ready_ns / 1000000), from_cache);
+    }
+    const animation::text_field* fields[FONT_COUNT] = {&anim->text_clock, &anim->text_percent};
+    const GRFont* fonts[FONT_COUNT];
+    for (int slot = 0; slot < FONT_COUNT; slot++) {
+        const animation::text_field& field = *fields[slot];
+        if (field.font != nullptr) {
+            fonts[slot] = field.font;
+        } else if (field.font_file.empty()) {
+            fonts[slot] = nullptr;
+        } else {
+            fonts[slot] = fonts_adopted_ ? loaded_fonts_[slot] : sys_font;
+        }
+    }
+    clock_font_ = fonts[FONT_CLOCK];
+    percent_font_ = fonts[FONT_PERCENT];
+}
+
+bool HealthdDraw::handle_font_event() {
+    uint64_t count;
+    if (font_event_fd_.get() >= 0) {
+        (void)TEMP_FAILURE_RETRY(read(font_event_fd_.get(), &count, sizeof(count)));
+    }
+    // The switch to the loaded fonts happens on the next redraw.
+    governor_.force_next_frame();
+    return true;
+}
+
+// Only ever raised by one thread, so no compare-and-swap is needed.
+static void raise_max(std::atomic<int64_t>* max, int64_t value) {
+    if (value > max->load(std::memory_order_relaxed)) max->store(value, std::memory_order_relaxed);
+}
 
 void HealthdDraw::redraw_screen(const animation* batt_anim, GRSurface* surf_unknown) {
     if (!graphics_available) return;
-    clear_screen();
+    int64_t start_ns = steady_now_ns();
+    clock_.update();
+    // A readout that changed without a level step, e.g. gone stale, is still a
+    // visible change.
+    if (charge_.add(start_ns / 1000000, batt_anim->cur_level, batt_anim->cur_status)) {
+        governor_.force_next_frame();
+    }
+    if (!admit_frame(batt_anim, start_ns)) return;
+    if (render_thread_.joinable()) {
+        requested_.has_frame = true;
+        requested_.level = batt_anim->cur_level;
+        requested_.status = batt_anim->cur_status;
+        requested_.num_frames = batt_anim->num_frames;
+        requested_.cur_frame = batt_anim->cur_frame;
+        requested_.surf_unknown = surf_unknown;
+        requested_.time = clock_.texts();
+        requested_.charge = charge_.text();
+        publish_requested(start_ns);
+        return;
+    }
+    render_frame(batt_anim, surf_unknown, clock_.texts(), charge_.text());
+}
 
-    /* try to display *something* */
-    if (batt_anim->cur_status == BATTERY_STATUS_UNKNOWN || batt_anim->cur_level < 0 ||
-        batt_anim->num_frames == 0)
-        draw_unknown(surf_unknown);
-    else
-        draw_battery(batt_anim);
-    gr_flip();
+static const char* governor_mode_name(FrameGovernor::Mode mode) {
+    switch (mode) {
+        case FrameGovernor::MODE_ACTIVE:
+            return "active";
+        case FrameGovernor::MODE_STEADY:
+            return "steady";
+        case FrameGovernor::MODE_THROTTLED:
+            return "throttled";
+        case FrameGovernor::MODE_STOPPED:
+            return "stopped";
+        default:
+            return "unknown";
+    }
+}
+
+bool HealthdDraw::admit_frame(const animation* batt_anim, int64_t now_ns) {
+    FrameGovernor::Inputs in = {};
+    in.blanked = blanked_mask_ == (1u << num_displays_) - 1;
+    in.animating = batt_anim->run && batt_anim->num_frames > 1;
+    in.level = batt_anim->cur_level;
+    in.status = batt_anim->cur_status;
+    in.full = batt_anim->cur_status == BATTERY_STATUS_FULL;
+    in.minute = clock_.texts().generation;
+    in.temperature = battery_temperature_;
+    bool admitted = governor_.admit(in, now_ns / 1000000);
+
+    FrameGovernor::Stats stats = governor_.stats(now_ns / 1000000);
+    if (stats.mode != governor_mode_) {
+        governor_mode_ = stats.mode;
+        LOGV("charger redraws %s, every %d ms, reason %d, %d frames last minute\n",
+             governor_mode_name(stats.mode), stats.interval_ms, stats.reason,
+             stats.frames_per_minute);
+    }
+    return admitted;
+}
+
+int HealthdDraw::next_redraw_ms() const {
+    return governor_.next_frame_ms(steady_now_ns() / 1000000);
+}
+
+FrameGovernor::Stats HealthdDraw::governor_stats() {
+    return governor_.stats(steady_now_ns() / 1000000);
+}
+
+void HealthdDraw::render_frame(const animation* batt_anim, GRSurface* surf_unknown,
+                               const ChargerClock::Texts& time,
+                               const ChargeRateEstimator::Text& charge) {
+    if (profile_dump_requested) dump_requested_profile();
+    profiler_.begin_frame();
+    bool presented;
+    {
+        HEALTHD_PROFILE_STAGE(&profiler_, STAGE_FRAME);
+        presented = present_frame(batt_anim, surf_unknown, time, charge);
+    }
+    if (presented) {
+        profiler_.end_frame();
+    } else {
+        profiler_.cancel_frame();
+    }
+}
+
+bool HealthdDraw::present_frame(const animation* batt_anim, GRSurface* surf_unknown,
+                                const ChargerClock::Texts& time,
+                                const ChargeRateEstimator::Text& charge) {
+    wait_prefetch();
+    resolve_fonts(batt_anim);
+
+    FrameKey key = {};
+    key.unknown = batt_anim->cur_status == BATTERY_STATUS_UNKNOWN || batt_anim->cur_level < 0 ||
+                  batt_anim->num_frames == 0;
+    key.level = batt_anim->cur_level;
+    key.status = batt_anim->cur_status;
+    key.frame = batt_anim->cur_frame < batt_anim->num_frames ? batt_anim->cur_frame : -1;
+    key.surf_unknown = surf_unknown;
+    frame_time_ = time;
+    frame_charge_ = charge;
+    glyph_runs_.begin_frame();
+
+    // Record the frame of every lit connector whose picture changes. The others
+    // keep what they show, or only have it copied back from their canvas.
+    Display* pending[kMaxConnectors];
+    int count = 0;
+    for (int i = 0; i < num_displays_; i++) {
+        Display& display = displays_[i];
+        if (display.blanked || !select_display(&display)) continue;
+        ensure_layout(batt_anim);
+
+        FrameKey display_key = key;
+        if (display.last_frame_uses_time) display_key.minute = time.generation;
+        if (display.last_frame_uses_charge) display_key.charge = charge.generation;
+        display.repaint = display.full_redraw || !(display_key == display.last_frame_key);
+        if (!display.repaint && !display.present_full) continue;
+        pending[count++] = &display;
+        if (!display.repaint) continue;
+
+        display.frame_ops.clear();
+        display.background = nullptr;
+        op_sink_ = &display.frame_ops;
+        frame_uses_time_ = false;
+        frame_uses_charge_ = false;
+
+        /* try to display *something* */
+        if (key.unknown)
+            draw_unknown(surf_unknown);
+        else
+            draw_battery(batt_anim);
+        compute_damage();
+
+        if (frame_uses_time_) display_key.minute = time.generation;
+        if (frame_uses_charge_) display_key.charge = charge.generation;
+        display.last_frame_key = display_key;
+        display.last_frame_uses_time = frame_uses_time_;
+        display.last_frame_uses_charge = frame_uses_charge_;
+    }
+
+    // Nothing visible changed: leave the presented frames on screen.
+    if (count == 0) {
+        frame_counters_.elided++;
+        return false;
+    }
+    paint_displays(pending, count);
+    present_displays(pending, count);
+
+    // Decode the next animation frame on paint_helper_ while this one is on
+    // screen, if the budget leaves a slot for it; adopt_animation_frames() then
+    // started the helper. The next frame waits for it before it is recorded.
+    if (!key.unknown && paint_helper_.joinable() && frame_store_.size() > 1 &&
+        frame_store_.stats().fallback == AnimationFrameStore::FALLBACK_NONE) {
+        std::lock_guard<std::mutex> lock(paint_mutex_);
+        prefetch_frame_ = (batt_anim->cur_frame + 1) % batt_anim->num_frames;
+        prefetch_busy_ = true;
+        paint_cv_.notify_all();
+    }
+
+    if (frame_counters_.presented++ == 0) {
+        int64_t first_frame_ns = steady_now_ns() - created_ns_;
+        {
+            std::lock_guard<std::mutex> lock(startup_mutex_);
+            startup_stats_.first_frame_ns = first_frame_ns;
+            startup_stats_.first_frame_fallback = !fonts_adopted_;
+        }
+        LOGI("charger first frame after %lld ms%s\n",
+             static_cast<long long>(first_frame_ns / 1000000),
+             fonts_adopted_ ? "" : ", fonts still loading");
+    }
+    return true;
+}
+
+void HealthdDraw::adopt_animation_frames(animation* anim) {
+    if (anim->frames == nullptr || anim->num_frames <= 0) return;
+    for (int i = 0; i < anim->num_frames; i++) {
+        if (!AnimationFrameStore::can_encode(anim->frames[i].surface)) {
+            LOGW("Keeping animation frames uncompressed\n");
+            return;
+        }
+    }
+    for (int i = 0; i < anim->num_frames; i++) {
+        frame_store_.add(anim->frames[i].surface);
+        res_free_surface(anim->frames[i].surface);
+        anim->frames[i].surface = nullptr;
+    }
+    AnimationFrameStore::Fallback fallback = frame_store_.fit_budget();
+    const AnimationFrameStore::Stats& stats = frame_store_.stats();
+    static constexpr const char* kFallbacks[] = {"", "without prefetching",
+                                                 "showing the last frame only", "without frames"};
+    if (fallback == AnimationFrameStore::FALLBACK_NO_FRAMES) {
+        LOGE("%zu animation frames of %zu KB exceed %s=%zu: drawing %s\n", stats.frames,
+             stats.frame_bytes / 1024, kFrameBudgetProperty, stats.budget_bytes / 1024,
+             kFallbacks[fallback]);
+    } else if (fallback != AnimationFrameStore::FALLBACK_NONE) {
+        LOGW("%zu animation frames of %zu KB exceed %s=%zu: drawing %s\n", stats.frames,
+             stats.frame_bytes / 1024, kFrameBudgetProperty, stats.budget_bytes / 1024,
+             kFallbacks[fallback]);
+    }
+    LOGV("%zu animation frames compressed to %zu bytes, up to %zu decoded\n", stats.frames,
+         stats.encoded_bytes, stats.cache_capacity);
+    if (fallback == AnimationFrameStore::FALLBACK_NONE && stats.frames > 1) start_paint_helper();
+}
+
+GRSurface* HealthdDraw::animation_frame(const animation* anim, int index, int* shown) {
+    *shown = index;
+    if (index < 0 || index >= anim->num_frames) return nullptr;
+    if (frame_store_.size() > 0) {
+        GRSurface* surface = frame_store_.get(index);
+        *shown = frame_store_.shown();
+        return surface;
+    }
+    return anim->frames ? anim->frames[index].surface : nullptr;
+}
+
+void HealthdDraw::request_profile_dump() {
+    profile_dump_requested = 1;
+}
+
+bool HealthdDraw::dump_profile(FILE* text, FILE* binary) const {
+    bool ok = true;
+    if (text != nullptr) ok &= profiler_.dump_text(text);
+    if (binary != nullptr) ok &= profiler_.dump_binary(binary);
+    return ok;
+}
+
+void HealthdDraw::dump_requested_profile() {
+    profile_dump_requested = 0;
+    if (!HEALTHD_DRAW_PROFILING) {
+        LOGW("Frame profiling is not built in\n");
+        return;
+    }
+    std::string prefix = base::GetProperty(kProfilePathProperty, "");
+    if (prefix.empty()) {
+        FILE* kmsg = fopen("/dev/kmsg", "we");
+        if (kmsg == nullptr) return;
+        // One kmsg record per line.
+        setvbuf(kmsg, nullptr, _IOLBF, 0);
+        dump_profile(kmsg, nullptr);
+        fclose(kmsg);
+        return;
+    }
+    FILE* text = fopen((prefix + ".txt").c_str(), "we");
+    FILE* binary = fopen((prefix + ".bin").c_str(), "we");
+    if (!dump_profile(text, binary) || text == nullptr || binary == nullptr) {
+        LOGE("Could not dump frame profile to %s\n", prefix.c_str());
+    }
+    if (text != nullptr) fclose(text);
+    if (binary != nullptr) fclose(binary);
 }
 
 void HealthdDraw::blank_screen(bool blank, int drm) {
     if (!graphics_available) return;
-    gr_fb_blank(blank, drm);
+    unsigned bit = 1u << (&display_for(drm) - displays_);
+    blanked_mask_ = blank ? blanked_mask_ | bit : blanked_mask_ & ~bit;
+    if (render_thread_.joinable()) {
+        int64_t start_ns = steady_now_ns();
+        if (drm < 0 || drm >= kMaxConnectors) {
+            LOGW("Cannot blank connector %d from the render thread\n", drm);
+            return;
+        }
+        requested_.blank[drm] = blank;
+        publish_requested(start_ns);
+        return;
+    }
+    apply_blank(blank, drm);
+}
+
+void HealthdDraw::apply_blank(bool blank, int drm) {
+    backend_->blank(blank, drm);
+    Display& display = display_for(drm);
+    // A single connector is drawn whatever its state, as it always was.
+    if (num_displays_ > 1) display.blanked = blank;
+    if (blank) return;
+    // Buffer contents are not guaranteed to survive a blank cycle. A frame
+    // composed offscreen is still intact, though, and only needs copying back.
+    if (display.canvas) {
+        display.present_full = true;
+    } else {
+        display.full_redraw = true;
+    }
 }
 
 // support screen rotation for foldable phone
 void HealthdDraw::rotate_screen(int drm) {
     if (!graphics_available) return;
+    governor_.force_next_frame();
+    if (render_thread_.joinable()) {
+        int64_t start_ns = steady_now_ns();
+        requested_.rotate_drm = drm;
+        requested_.rotate_seq++;
+        publish_requested(start_ns);
+        return;
+    }
+    apply_rotation(drm);
+}
+
+void HealthdDraw::apply_rotation(int drm) {
+    Display& display = display_for(drm);
+    GRRotation rotation;
     if (drm == 0)
-        gr_rotate(GRRotation::RIGHT /* landscape mode */);
+        rotation = GRRotation::RIGHT /* landscape mode */;
     else
-        gr_rotate(GRRotation::NONE /* Portrait mode */);
+        rotation = GRRotation::NONE /* Portrait mode */;
+    if (display.rotated && display.rotation == rotation) return;
+    // The orientation shown before is parked and the one rotated to, kept from
+    // when it was last shown, takes its place.
+    if (display.rotated) {
+        OrientationState& current = display;
+        std::swap(current, display.parked);
+    }
+    display.rotated = true;
+    display.rotation = rotation;
+    // The backend is rotated when the display is next drawn, and ensure_layout()
+    // rebuilds whatever does not fit its new size. The screen still shows the
+    // other orientation: a canvas holds this one's last frame and only needs
+    // copying, anything else is drawn again.
+    if (display.canvas) {
+        display.present_full = true;
+    } else {
+        display.full_redraw = true;
+    }
 }
 
-// detect dual display
-bool HealthdDraw::has_multiple_connectors() {
-    return graphics_available && gr_has_multiple_connectors();
+HealthdDraw::Display& HealthdDraw::display_for(int drm) {
+    if (drm < 0 || drm >= num_displays_) return displays_[0];
+    return displays_[drm];
 }
 
-void HealthdDraw::clear_screen(void) {
-    if (!graphics_available) return;
-    gr_color(0, 0, 0, 255);
-    gr_clear();
+const HealthdDraw::Display& HealthdDraw::display_for(int drm) const {
+    if (drm < 0 || drm >= num_displays_) return displays_[0];
+    return displays_[drm];
 }
 
-int HealthdDraw::draw_surface_centered(GRSurface* surface) {
-    if (!graphics_available) return 0;
-
-    int w = gr_get_width(surface);
-    int h = gr_get_height(surface);
-    int x = (screen_width_ - w) / 2 + kSplitOffset;
-    int y = (screen_height_ - h) / 2;
+bool HealthdDraw::select_display(Display* display) {
+    if (num_displays_ > 1 && !backend_->select_connector(display->drm)) return false;
+    if (display->rotated) backend_->rotate(display->rotation);
+    display_ = display;
+    return true;
+}
 
-    LOGV("drawing surface %dx%d+%d+%d\n", w, h, x, y);
-    gr_blit(surface, 0, 0, w, h, x, y);
-    if (kSplitScreen) {
-        x += screen_width_ - 2 * kSplitOffset;
-        LOGV("drawing surface %dx%d+%d+%d\n", w, h, x, y);
-        gr_blit(surface, 0, 0, w, h, x, y);
+bool HealthdDraw::start_render_thread(const animation* anim) {
+    if (!graphics_available || render_thread_.joinable()) return false;
+    if (!mailbox_.valid()) {
+        LOGE("Could not create render thread mailbox\n");
+        return false;
     }
+    mailbox_.reopen();
+    render_anim_ = *anim;
+    requested_ = {};
+    std::fill(std::begin(requested_.blank), std::end(requested_.blank), -1);
+    render_thread_ = std::thread(&HealthdDraw::render_loop, this);
+    return true;
+}
 
-    return y + h;
+void HealthdDraw::stop_render_thread() {
+    if (!render_thread_.joinable()) return;
+    mailbox_.close();
+    render_thread_.join();
 }
 
-int HealthdDraw::draw_text(const GRFont* font, int x, int y, const char* str) {
-    if (!graphics_available) return 0;
-    int str_len_px = gr_measure(font, str);
+HealthdDraw::RenderThreadStats HealthdDraw::render_thread_stats() const {
+    RenderThreadStats stats = {};
+    stats.published = mailbox_.published();
+    stats.rendered = mailbox_.taken();
+    stats.coalesced = mailbox_.coalesced();
+    stats.max_publish_ns = max_publish_ns_.load(std::memory_order_relaxed);
+    stats.max_present_latency_ns = max_present_latency_ns_.load(std::memory_order_relaxed);
+    return stats;
+}
 
-    if (x < 0) x = (screen_width_ - str_len_px) / 2;
-    if (y < 0) y = (screen_height_ - char_height_) / 2;
-    gr_text(font, x + kSplitOffset, y, str, false /* bold */);
-    if (kSplitScreen) gr_text(font, x - kSplitOffset + screen_width_, y, str, false /* bold */);
+HealthdDraw::StartupStats HealthdDraw::startup_stats() const {
+    std::lock_guard<std::mutex> lock(startup_mutex_);
+    return startup_stats_;
+}
 
-    return y + char_height_;
+void HealthdDraw::publish_requested(int64_t start_ns) {
+    requested_.published_ns = start_ns;
+    mailbox_.publish(requested_);
+    raise_max(&max_publish_ns_, steady_now_ns() - start_ns);
 }
 
-void HealthdDraw::determine_xy(const animation::text_field& field, const int length, int* x,
-                               int* y) {
-    *x = field.pos_x;
-    screen_width_ = gr_fb_width() / (kSplitScreen ? 2 : 1);
-    screen_height_ = gr_fb_height();
-
-    int str_len_px = length * field.font->char_width;
-    if (field.pos_x == CENTER_VAL) {
-        *x = (screen_width_ - str_len_px) / 2;
-    } else if (field.pos_x >= 0) {
-        *x = field.pos_x;
-    } else {  // position from max edge
-        *x = screen_width_ + field.pos_x - str_len_px - kSplitOffset;
+void HealthdDraw::render_loop() {
+    // What has been applied so far, to act only on what changed.
+    int8_t blanked[kMaxConnectors];
+    std::fill(std::begin(blanked), std::end(blanked), -1);
+    uint64_t rotate_seq = 0;
+
+    while (const RenderState* state = mailbox_.take()) {
+        for (int drm = 0; drm < kMaxConnectors; drm++) {
+            if (state->blank[drm] < 0 || state->blank[drm] == blanked[drm]) continue;
+            blanked[drm] = state->blank[drm];
+            apply_blank(blanked[drm], drm);
+        }
+        if (state->rotate_seq != rotate_seq) {
+            rotate_seq = state->rotate_seq;
+            apply_rotation(state->rotate_drm);
+        }
+        if (state->has_frame) {
+            render_anim_.cur_level = state->level;
+            render_anim_.cur_status = state->status;
+            render_anim_.num_frames = state->num_frames;
+            render_anim_.cur_frame = state->cur_frame;
+            render_frame(&render_anim_, state->surf_unknown, state->time, state->charge);
+        }
+        raise_max(&max_present_latency_ns_, steady_now_ns() - state->published_ns);
     }
+}
 
-    *y = field.pos_y;
+bool HealthdDraw::DrawOp::operator==(const DrawOp& o) const {
+    return kind == o.kind && font == o.font && surface == o.surface && frame == o.frame &&
+           x == o.x && y == o.y &&
+           r == o.r && g == o.g && b == o.b && a == o.a && dither == o.dither && rect == o.rect &&
+           strcmp(text, o.text) == 0;
+}
 
-    if (field.pos_y == CENTER_VAL) {
-        *y = (screen_height_ - field.font->char_height) / 2;
-    } else if (field.pos_y >= 0) {
-        *y = field.pos_y;
-    } else {  // position from max edge
-        *y = screen_height_ + field.pos_y - field.font->char_height;
-    }
+void HealthdDraw::set_color(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    color_r_ = r;
+    color_g_ = g;
+    color_b_ = b;
+    color_a_ = a;
 }
 
-void HealthdDraw::draw_clock(const animation* anim) {
-    static constexpr char CLOCK_FORMAT[] = "%H:%M";
-    static constexpr int CLOCK_LENGTH = 6;
+void HealthdDraw::invalidate() {
+    for (int i = 0; i < num_displays_; i++) {
+        displays_[i].full_redraw = true;
+        displays_[i].parked.full_redraw = true;
+    }
+}
 
-    const animation::text_field& field = anim->text_clock;
+DrawRect HealthdDraw::canvas_rect() const {
+    return {0, 0, display_->screen_width, display_->screen_height};
+}
 
-    if (!graphics_available || field.font == nullptr || field.font->char_width == 0 ||
-        field.font->char_height == 0)
-        return;
+DrawRect HealthdDraw::clip_to_canvas(const DrawRect& rect) const {
+    return rect.intersection(canvas_rect());
+}
 
-    time_t rawtime;
-    time(&rawtime);
-    tm* time_info = localtime(&rawtime);
+void HealthdDraw::add_damage(const DrawRect& rect) {
+    std::vector<DrawRect>& damage = display_->damage;
+    DrawRect clipped = clip_to_canvas(rect);
+    if (clipped.empty()) return;
+    for (const DrawRect& d : damage) {
+        if (d.contains(clipped)) return;
+    }
+    damage.push_back(clipped);
+    if (damage.size() <= kMaxDamageRects) return;
+
+    // Too fragmented; fall back to the bounding box.
+    int x1 = INT_MAX, y1 = INT_MAX, x2 = INT_MIN, y2 = INT_MIN;
+    for (const DrawRect& d : damage) {
+        x1 = std::min(x1, d.x);
+        y1 = std::min(y1, d.y);
+        x2 = std::max(x2, d.x + d.w);
+        y2 = std::max(y2, d.y + d.h);
+    }
+    damage.clear();
+    damage.push_back({x1, y1, x2 - x1, y2 - y1});
+}
 
-    char clock_str[CLOCK_LENGTH];
-    size_t length = strftime(clock_str, CLOCK_LENGTH, CLOCK_FORMAT, time_info);
-    if (length != CLOCK_LENGTH - 1) {
-        LOGE("Could not format time\n");
-        return;
+void HealthdDraw::compute_damage() {
+    Display& display = *display_;
+    display.damage.clear();
+    display.frame_stats = {};
+    if (display.full_redraw || display.background != display.last_background) {
+        add_damage(canvas_rect());
+        display.frame_stats.full_redraw = true;
+        display.full_redraw = false;
+        // A repaint in full leaves nothing for a pending copy-back to add.
+        display.present_full = false;
+    } else {
+        const std::vector<DrawOp>& ops = display.frame_ops;
+        const std::vector<DrawOp>& last_ops = display.last_ops;
+        size_t count = std::max(ops.size(), last_ops.size());
+        for (size_t i = 0; i < count; i++) {
+            bool in_new = i < ops.size();
+            bool in_old = i < last_ops.size();
+            if (in_new && in_old && ops[i] == last_ops[i]) continue;
+            if (in_new) add_damage(ops[i].rect);
+            if (in_old) add_damage(last_ops[i].rect);
+        }
     }
 
-    int x, y;
-    determine_xy(field, length, &x, &y);
+    // Remember this frame's own damage before folding in the older frames the
+    // back buffer has not seen yet. A canvas is ours and single-buffered, so
+    // there the older damage only matters when presenting.
+    display.own_damage = display.damage;
+    if (!display.canvas) {
+        for (const std::vector<DrawRect>& older : display.damage_history) {
+            for (const DrawRect& d : older) add_damage(d);
+        }
+    }
 
-    LOGV("drawing clock %s %d %d\n", clock_str, x, y);
-    gr_color(field.color_r, field.color_g, field.color_b, field.color_a);
-    draw_text(field.font, x, y, clock_str);
+    // Text is alpha-blended, so an op partially covered by damage would be blended
+    // twice over its old pixels. Grow the damage until it covers every op it touches.
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (const DrawOp& op : display.frame_ops) {
+            DrawRect rect = clip_to_canvas(op.rect);
+            bool touched = false, covered = false;
+            for (const DrawRect& d : display.damage) {
+                touched |= d.intersects(rect);
+                covered |= d.contains(rect);
+            }
+            if (touched && !covered) {
+                add_damage(rect);
+                grown = true;
+            }
+        }
+    }
 }
 
-/**
- * @brief Desenha a data atual na tela de carregamento.
- *
- * A data é formatada como DD/MM/AAAA e desenhada abaixo do campo de porcentagem.
- *
- * @param anim Estrutura de animação para obter a fonte e a posição.
- */
-void HealthdDraw::draw_date(const animation* anim) {
-    // Usa o campo de porcentagem como base para o estilo de fonte.
-    const animation::text_field& percent_field = anim->text_percent;
-    if (percent_field.font == nullptr) return;
+void HealthdDraw::paint_displays(Display* const* displays, int count) {
+    PixelFormat format = backend_->pixel_format();
+    // Displays composed offscreen share nothing but read-only inputs, so all but
+    // the first one repainted are handed to paint_helper_. Only this thread's
+    // display is profiled.
+    Display* local = nullptr;
+    Display* jobs[kMaxConnectors];
+    int job_count = 0;
+    for (int i = 0; i < count; i++) {
+        Display* display = displays[i];
+        if (!display->repaint) continue;
+        if (!display->canvas) {
+            // Painted straight to the screen, so its connector must be current.
+            select_display(display);
+            paint_display(display, format, &profiler_, false /* tiled */);
+        } else if (local == nullptr) {
+            local = display;
+        } else {
+            jobs[job_count++] = display;
+        }
+    }
+    if (job_count > 0) {
+        start_paint_helper();
+        std::lock_guard<std::mutex> lock(paint_mutex_);
+        std::copy(jobs, jobs + job_count, paint_jobs_);
+        paint_job_count_ = job_count;
+        paint_format_ = format;
+        paint_busy_ = true;
+        paint_cv_.notify_all();
+    }
+    if (local != nullptr) paint_display(local, format, &profiler_, true /* tiled */);
+    if (job_count > 0) {
+        std::unique_lock<std::mutex> lock(paint_mutex_);
+        paint_cv_.wait(lock, [this] { return !paint_busy_; });
+    }
+}
 
-    // Obtém a data e hora local do sistema.
-    time_t rawtime;
-    time(&rawtime);
-    tm* time_info = localtime(&rawtime);
+void HealthdDraw::paint_helper_loop() {
+    std::unique_lock<std::mutex> lock(paint_mutex_);
+    while (true) {
+        paint_cv_.wait(lock, [this] {
+            return paint_exit_ || paint_job_count_ > 0 || prefetch_frame_ >= 0;
+        });
+        if (paint_exit_) return;
+        if (prefetch_frame_ >= 0) {
+            int index = prefetch_frame_;
+            prefetch_frame_ = -1;
+            lock.unlock();
+            frame_store_.prefetch(index);
+            lock.lock();
+            prefetch_busy_ = false;
+            paint_cv_.notify_all();
+            continue;
+        }
+        Display* jobs[kMaxConnectors];
+        int job_count = paint_job_count_;
+        std::copy(paint_jobs_, paint_jobs_ + job_count, jobs);
+        paint_job_count_ = 0;
+        PixelFormat format = paint_format_;
+        lock.unlock();
+        for (int i = 0; i < job_count; i++) {
+            paint_display(jobs[i], format, nullptr, false /* tiled */);
+        }
+        lock.lock();
+        paint_busy_ = false;
+        paint_cv_.notify_all();
+    }
+}
 
-    // Define o formato da data.
-    static constexpr char DATETIME_FORMAT[] = "%d/%m/%Y";
-    LOGE("draw_date: MONTOU A DATA");
-    static constexpr int DATETIME_LENGTH = 11;
-    char datetime_str[DATETIME_LENGTH];
+void HealthdDraw::start_paint_helper() {
+    if (!paint_helper_.joinable()) {
+        paint_helper_ = std::thread(&HealthdDraw::paint_helper_loop, this);
+    }
+}
 
-    // Formata a data.
-    size_t length = strftime(datetime_str, DATETIME_LENGTH, DATETIME_FORMAT, time_info);
-    if (length < 1) return;
+void HealthdDraw::stop_paint_helper() {
+    if (!paint_helper_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(paint_mutex_);
+        paint_exit_ = true;
+        paint_cv_.notify_all();
+    }
+    paint_helper_.join();
+}
 
-    int x, y;
-    // Calcula posição X e Y inicial (geralmente centro da tela).
-    determine_xy(percent_field, length, &x, &y);
+void HealthdDraw::wait_prefetch() {
+    std::unique_lock<std::mutex> lock(paint_mutex_);
+    paint_cv_.wait(lock, [this] { return !prefetch_busy_; });
+}
 
-    // POSICIONAMENTO: Move o texto para baixo, 50px abaixo da altura da fonte.
-    y += percent_field.font->char_height + 50;
+AnimationFrameStore::Stats HealthdDraw::frame_store_stats() {
+    wait_prefetch();
+    return frame_store_.stats();
+}
 
-    // Cor: Branco total (255, 255, 255).
-    gr_color(255, 255, 255, 255);
+void HealthdDraw::paint_display(Display* display, PixelFormat format, FrameProfiler* profiler,
+                                bool tiled) {
+    Display& d = *display;
+    DrawRect canvas = {0, 0, d.screen_width, d.screen_height};
+    int top = 0, bottom = canvas.h;
+    int bands = tiled ? plan_bands(d, &top, &bottom) : 1;
+    if (bands > 1) {
+        // Each band is cleared and painted in one go, so it all counts as painting.
+        HEALTHD_PROFILE_STAGE(profiler, STAGE_PAINT);
+        BandJob job = {this, display, format, top, bottom, (bottom - top + bands - 1) / bands};
+        tile_pool_->run(bands, &HealthdDraw::paint_band, &job);
+    } else {
+        {
+            HEALTHD_PROFILE_STAGE(profiler, STAGE_CLEAR);
+            if (!d.background && !d.canvas && d.damage.size() == 1 && d.damage[0] == canvas) {
+                clear_screen();
+            } else {
+                clear_rows(display, format, 0, canvas.h);
+            }
+        }
+        {
+            HEALTHD_PROFILE_STAGE(profiler, STAGE_PAINT);
+            paint_rows(display, format, 0, canvas.h);
+        }
+    }
 
-    // Desenha a data/hora formatada.
-    draw_text(percent_field.font, x, y, datetime_str);
+    for (const DrawRect& r : d.damage) {
+        d.frame_stats.pixels_cleared += static_cast<int64_t>(r.w) * r.h;
+    }
+    for (const DrawOp& op : d.frame_ops) {
+        DrawRect rect = op.rect.intersection(canvas);
+        bool touched = false;
+        for (const DrawRect& r : d.damage) touched |= r.intersects(rect);
+        if (touched) d.frame_stats.pixels_painted += static_cast<int64_t>(rect.w) * rect.h;
+    }
+    d.frame_stats.damage_rects = d.damage.size();
+    d.frame_stats.bands = bands;
+    d.frame_stats.bytes_written = (d.frame_stats.pixels_cleared + d.frame_stats.pixels_painted) *
+                                  (d.canvas ? d.canvas->pixel_bytes : sizeof(uint32_t));
 }
 
-/**
- * @brief Desenha o cabeçalho principal ("DevTITANS") no TOPO da tela.
- *
- * Utiliza a mesma fonte do campo de porcentagem para manter o estilo visual desejado.
- *
- * @param anim Estrutura de animação.
- */
-void HealthdDraw::draw_header(const animation* anim) {
-    if (!graphics_available) return;
+int HealthdDraw::plan_bands(const Display& display, int* top, int* bottom) const {
+    if (!tile_pool_ || !display.canvas || display.damage.empty()) return 1;
+    int64_t pixels = 0;
+    int y1 = display.screen_height, y2 = 0;
+    for (const DrawRect& r : display.damage) {
+        pixels += static_cast<int64_t>(r.w) * r.h;
+        y1 = std::min(y1, r.y);
+        y2 = std::max(y2, r.y + r.h);
+    }
+    if (pixels < kMinTiledPixels || y2 <= y1) return 1;
+    *top = y1;
+    *bottom = y2;
+    return std::clamp((y2 - y1) / kMinBandRows, 1, kRenderThreads * kBandsPerThread);
+}
 
-    // Obtém as propriedades (Fonte, Cores, Posição) do campo de porcentagem
-    const animation::text_field& percent_field = anim->text_percent;
-    if (percent_field.font == nullptr) return;
+void HealthdDraw::paint_band(void* job, int band) {
+    const BandJob& j = *static_cast<const BandJob*>(job);
+    int y1 = j.top + band * j.rows;
+    int y2 = std::min(y1 + j.rows, j.bottom);
+    if (y2 <= y1) return;
+    j.draw->clear_rows(j.display, j.format, y1, y2);
+    j.draw->paint_rows(j.display, j.format, y1, y2);
+}
 
-    std::string header_text = base::StringPrintf("DevTITANS");
-    int length = header_text.size();
+void HealthdDraw::clear_rows(Display* display, PixelFormat format, int y1, int y2) {
+    Display& d = *display;
+    // The background is opaque, so restoring it needs no blending: the static
+    // layer is copied back, or black is filled.
+    for (const DrawRect& damage : d.damage) {
+        DrawRect r = damage.intersection({damage.x, y1, damage.w, y2 - y1});
+        if (r.empty()) continue;
+        if (d.background) {
+            canvas_blit(display, d.background, r.x, r.y, r.w, r.h, r.x, r.y, format);
+        } else {
+            canvas_fill_black(display, r, format);
+        }
+    }
+}
 
-    int x, y;
-    animation::text_field temp_field = percent_field;
+void HealthdDraw::paint_rows(Display* display, PixelFormat format, int y1, int y2) {
+    Display& d = *display;
+    DrawRect canvas = {0, 0, d.screen_width, d.screen_height};
+    // Texts come sorted by font and color, so the color rarely changes.
+    PaintState state;
+    for (const DrawOp& op : d.frame_ops) {
+        DrawRect rect = op.rect.intersection(canvas);
+        if (rect.y >= y2 || rect.y + rect.h <= y1) continue;
+        bool touched = false;
+        for (const DrawRect& r : d.damage) touched |= r.intersects(rect);
+        if (!touched) continue;
+        paint_op(display, op, format, &state, y1, y2);
+    }
+}
 
-    // POSICIONAMENTO PARA O TOPO:
-    // Usa a altura da fonte do campo de porcentagem para o cálculo de margem (20px de topo).
-    temp_field.pos_y = 20 + percent_field.font->char_height;
+void HealthdDraw::present_displays(Display* const* displays, int count) {
+    for (int i = 0; i < count; i++) {
+        Display& display = *displays[i];
+        select_display(&display);
+        if (!display.canvas) {
+            display.present_damage = display.damage;
+            continue;
+        }
+        if (!display.repaint) {
+            display.damage.clear();
+            display.own_damage.clear();
+            display.frame_stats = {};
+        }
+        if (display.present_full) {
+            // Neither back buffer can be trusted, so the next frame copies it all too.
+            add_damage(canvas_rect());
+            display.own_damage = display.damage;
+            display.present_full = false;
+        }
+        for (const std::vector<DrawRect>& older : display.damage_history) {
+            for (const DrawRect& d : older) add_damage(d);
+        }
+        present_canvas();
+    }
+    flip(displays, count);
 
-    // Calcula posição X e Y final usando o novo pos_y (topo).
-    determine_xy(temp_field, length, &x, &y);
+    for (int i = 0; i < count; i++) {
+        Display& display = *displays[i];
+        for (int age = kBufferAge - 2; age > 0; age--) {
+            display.damage_history[age] = display.damage_history[age - 1];
+        }
+        if (kBufferAge > 1) display.damage_history[0].swap(display.own_damage);
+        if (!display.repaint) continue;
+        display.last_ops.swap(display.frame_ops);
+        display.last_background = display.background;
+    }
+}
 
-    // Define a cor VERDE ESMERALDA (R:0, G:179, B:13, A:255).
-    gr_color(0, 179, 13, 255);
+void HealthdDraw::present_canvas() {
+    HEALTHD_PROFILE_STAGE(&profiler_, STAGE_PRESENT);
+    Display& display = *display_;
+    // In split-screen mode the left copy is pushed right by kSplitOffset and the
+    // right copy sits one half further, pushed back left by the same amount.
+    const int split_shifts[] = {kSplitOffset, display.screen_width - kSplitOffset};
+    const int whole_shift[] = {0};
+    const int* shifts = kSplitScreen ? split_shifts : whole_shift;
+    const int shift_count = kSplitScreen ? 2 : 1;
+    DrawRect screen = {0, 0, backend_->width(), backend_->height()};
+    const int64_t screen_pixel_bytes = backend_->native_rgb565() ? 2 : sizeof(uint32_t);
+    bool full = false;
+    for (const DrawRect& d : display.damage) full |= d == canvas_rect();
+
+    display.present_damage.clear();
+    std::vector<DrawRect>& copy = display.present_copy;
+    copy = display.damage;
+    if (full) display.present_damage.push_back(screen);
+    if (full && kSplitScreen && display.repaint) {
+        // A canvas repainted in full is black but for the background texts and
+        // the ops, so the screen is filled black, which only writes, and just
+        // those are copied, instead of reading the whole canvas twice.
+        clear_screen();
+        display.frame_stats.bytes_written +=
+                static_cast<int64_t>(screen.w) * screen.h * screen_pixel_bytes;
+        copy.clear();
+        if (display.background) {
+            const DrawList& list = display.draw_list;
+            for (size_t i = 0; i < list.static_count; i++) {
+                copy.push_back(clip_to_canvas(list.rect[i * DrawList::kVariants]));
+            }
+        }
+        for (const DrawOp& op : display.frame_ops) copy.push_back(clip_to_canvas(op.rect));
+    } else if (full && kSplitScreen) {
+        // Blacks out only the columns the offset copies leave uncovered.
+        backend_->color(0, 0, 0, 255);
+        int x = 0;
+        for (int i = 0; i <= shift_count; i++) {
+            int x2 = i < shift_count ? std::min(shifts[i], screen.w) : screen.w;
+            if (x2 > x) {
+                backend_->fill(x, 0, x2, screen.h);
+                display.frame_stats.bytes_written +=
+                        static_cast<int64_t>(x2 - x) * screen.h * screen_pixel_bytes;
+            }
+            if (i < shift_count) x = std::max(x, shifts[i] + display.screen_width);
+        }
+    }
+    for (const DrawRect& d : copy) {
+        if (d.empty()) continue;
+        for (int i = 0; i < shift_count; i++) {
+            int shift = shifts[i];
+            int x1 = std::max(d.x + shift, 0);
+            int x2 = std::min(d.x + d.w + shift, screen.w);
+            if (x2 <= x1) continue;
+            backend_->blit(display.canvas.get(), x1 - shift, d.y, x2 - x1, d.h, x1, d.y);
+            if (!full) display.present_damage.push_back({x1, d.y, x2 - x1, d.h});
+            display.frame_stats.bytes_written +=
+                    static_cast<int64_t>(x2 - x1) * d.h * screen_pixel_bytes;
+        }
+    }
+}
 
-    // Desenha o texto usando a FONTE DO PERCENTUAL, conforme solicitado.
-    draw_text(percent_field.font, x, y, header_text.c_str());
+void HealthdDraw::invalidate_static_layer() {
+    display_->static_layer.reset();
 }
 
-/**
- * @brief Desenha o subcabeçalho ("2025/1") em VERMELHO, logo abaixo do cabeçalho principal.
- *
- * @param anim Estrutura de animação.
- */
-void HealthdDraw::draw_subheader(const animation* anim) {
-    if (!graphics_available) return;
+void HealthdDraw::build_static_layer(const animation* /* anim */) {
+    if (display_->static_layer) return;
+    HEALTHD_PROFILE_STAGE(&profiler_, STAGE_STATIC_LAYER);
+    DrawRect canvas = canvas_rect();
 
-    const animation::text_field& percent_field = anim->text_percent;
-    if (percent_field.font == nullptr) return;
+    const DrawList& list = display_->draw_list;
 
-    std::string subheader_text = base::StringPrintf("$ 2025/1 @");
-    int length = subheader_text.size();
+    std::unique_ptr<GRSurface>& layer = display_->static_layer;
+    layer = raster_create(canvas.w, canvas.h, kRgb565 ? 2 : sizeof(uint32_t));
+    if (!layer) {
+        LOGE("Could not allocate static layer\n");
+        return;
+    }
+    PixelFormat format = backend_->pixel_format();
+    raster_fill(layer.get(), 0, 0, canvas.w, canvas.h,
+                raster_pack_for(layer.get(), format, 0, 0, 0, 255));
+    for (size_t i = 0; i < list.static_count; i++) {
+        const DrawRect& rect = list.rect[i * DrawList::kVariants];
+        uint32_t rgba = list.color[i];
+        raster_text(layer.get(), list.font[i], rect.x, rect.y, list.text[i],
+                    raster_pack_for(layer.get(), format, rgba >> 24, rgba >> 16, rgba >> 8, rgba));
+    }
+    LOGV("static layer rebuilt %dx%d, %zu texts\n", canvas.w, canvas.h, list.static_count);
+}
 
-    int x, y;
-    animation::text_field temp_field = percent_field;
+void HealthdDraw::canvas_blit(Display* display, const GRSurface* source, int sx, int sy, int w,
+                              int h, int dx, int dy, PixelFormat format, int y1, int y2) {
+    if (display->canvas) {
+        // Images are dithered when reduced to an RGB565 canvas.
+        raster_blit_convert_rows(display->canvas.get(), source, format, sx, sy, w, h, dx, dy,
+                                 true /* dither */, y1, y2);
+    } else {
+        backend_->blit(source, sx, sy, w, h, dx, dy);
+    }
+}
 
-    // POSICIONAMENTO: 20 (margem topo) + altura da fonte do cabeçalho + 10 (espaço) + altura da
-    // fonte do subheader Usa a altura da fonte do percentual para o cálculo.
-    temp_field.pos_y = 20 + (2 * percent_field.font->char_height) + 10;
+void HealthdDraw::canvas_fill_black(Display* display, const DrawRect& rect, PixelFormat format) {
+    if (display->canvas) {
+        raster_fill(display->canvas.get(), rect.x, rect.y, rect.x + rect.w, rect.y + rect.h,
+                    raster_pack_for(display->canvas.get(), format, 0, 0, 0, 255));
+    } else {
+        backend_->color(0, 0, 0, 255);
+        backend_->fill(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h);
+    }
+}
 
-    // Calcula a posição.
-    determine_xy(temp_field, length, &x, &y);
+void HealthdDraw::paint_op(Display* display, const DrawOp& op, PixelFormat format,
+                           PaintState* state, int y1, int y2) {
+    if (op.kind == DrawOp::SURFACE) {
+        canvas_blit(display, op.surface, 0, 0, op.rect.w, op.rect.h, op.x, op.y, format, y1, y2);
+        return;
+    }
+    uint32_t rgba = pack_element_color(op.r, op.g, op.b, op.a);
+    if (!state->valid || state->rgba != rgba) {
+        state->valid = true;
+        state->rgba = rgba;
+        if (display->canvas) {
+            state->pixel = raster_pack_for(display->canvas.get(), format, op.r, op.g, op.b, op.a);
+        } else {
+            backend_->color(op.r, op.g, op.b, op.a);
+        }
+    }
+    // A run is blended in one pass per row if it fits whole; otherwise glyphs
+    // are drawn until one does not fit, as before.
+    const GRSurface* mask = op.run ? op.run->mask : nullptr;
+    int width = display->canvas ? display->canvas->width : display->screen_width;
+    int height = display->canvas ? display->canvas->height : display->screen_height;
+    bool whole = mask && op.x >= 0 && op.y >= 0 && op.x + static_cast<int>(mask->width) <= width &&
+                 op.y + static_cast<int>(mask->height) <= height;
+    if (display->canvas && whole) {
+        raster_mask_rows(display->canvas.get(), mask, op.x, op.y, state->pixel, op.dither, y1, y2);
+    } else if (display->canvas) {
+        raster_text_rows(display->canvas.get(), op.font, op.x, op.y, op.text, state->pixel,
+                         op.dither, y1, y2);
+    } else if (whole) {
+        backend_->text_mask(mask, op.x, op.y);
+    } else {
+        backend_->text(op.font, op.x, op.y, op.text, false /* bold */);
+    }
+}
+
+void HealthdDraw::flip(Display* const* displays, int count) {
+    HEALTHD_PROFILE_STAGE(&profiler_, STAGE_FLIP);
+    // The last display presented is still the backend's current connector.
+    if (count == 1) {
+        backend_->flip(displays[0]->present_damage);
+        return;
+    }
+    int drms[kMaxConnectors];
+    const std::vector<DrawRect>* damage[kMaxConnectors];
+    for (int i = 0; i < count; i++) {
+        drms[i] = displays[i]->drm;
+        damage[i] = &displays[i]->present_damage;
+    }
+    backend_->flip_connectors(drms, damage, count);
+}
 
-    // Define a cor VERMELHA RUBY (R:185, G:30, B:60, A:255).
-    gr_color(185, 30, 60, 255);
+bool HealthdDraw::handle_clock_event() {
+    // The render thread owns the frame state and skips the redraw itself if the
+    // time is not shown.
+    if (render_thread_.joinable()) return clock_.on_timer();
+    if (!clock_.on_timer()) return false;
+    // Only worth a redraw if a last frame actually shows the time.
+    for (int i = 0; i < num_displays_; i++) {
+        if (displays_[i].last_frame_uses_time) return true;
+    }
+    return false;
+}
 
-    // Desenha o texto usando a FONTE DO PERCENTUAL, conforme solicitado.
-    draw_text(percent_field.font, x, y, subheader_text.c_str());
+// detect dual display
+bool HealthdDraw::has_multiple_connectors() {
+    return graphics_available && backend_->has_multiple_connectors();
 }
 
-/**
- * @brief Desenha a string de versão no RODAPÉ da tela.
- *
- * @param anim Estrutura de animação.
- */
-void HealthdDraw::draw_version(const animation* anim) {
+void HealthdDraw::clear_screen(void) {
     if (!graphics_available) return;
+    backend_->color(0, 0, 0, 255);
+    backend_->clear();
+}
 
-    const animation::text_field& percent_field = anim->text_percent;
-    if (percent_field.font == nullptr) return;
+int HealthdDraw::draw_surface_centered(GRSurface* surface) {
+    if (!graphics_available) return 0;
 
-    std::string version_str = base::StringPrintf("v2.7.3-final");
-    int length = version_str.size();
+    int w = surface->width;
+    int h = surface->height;
+    // In split-screen mode ops are recorded once in half-screen coordinates and
+    // present_canvas() applies the offset to both copies.
+    int x = (display_->screen_width - w) / 2 + (kSplitScreen ? 0 : kSplitOffset);
+    int y = (display_->screen_height - h) / 2;
 
-    int x, y;
-    animation::text_field temp_field = percent_field;
+    DrawOp op = {};
+    op.kind = DrawOp::SURFACE;
+    op.surface = surface;
+    op.frame = -1;
+    op.r = op.g = op.b = op.a = 255;
 
-    // AJUSTE PARA O RODAPÉ: O valor NEGATIVO ativa o alinhamento inferior.
-    // -20px de margem a partir da borda inferior.
-    temp_field.pos_y = -20 - percent_field.font->char_height;
+    LOGV("drawing surface %dx%d+%d+%d\n", w, h, x, y);
+    op.x = x;
+    op.y = y;
+    op.rect = {x, y, w, h};
+    op_sink_->push_back(op);
 
-    determine_xy(temp_field, length, &x, &y);
+    return y + h;
+}
 
-    // Define a cor AZUL SAFIRA (R:20, G:90, B:200, A:255).
-    gr_color(20, 90, 200, 255);
+int HealthdDraw::draw_text(const GRFont* font, int x, int y, const char* str) {
+    if (!graphics_available) return 0;
+    DrawOp op = {};
+    if (snprintf(op.text, sizeof(op.text), "%s", str) >= static_cast<int>(sizeof(op.text))) {
+        LOGW("Text cut to %zu characters: '%s'\n", sizeof(op.text) - 1, str);
+    }
+    // Measured once per run, when it is made; texts that cannot be cached are
+    // measured every time.
+    op.run = glyph_runs_.get(font, op.text);
+    int str_len_px = op.run ? op.run->width : backend_->measure(font, op.text);
+
+    if (x < 0) x = (display_->screen_width - str_len_px) / 2;
+    if (y < 0) y = (display_->screen_height - char_height_) / 2;
+
+    op.kind = DrawOp::TEXT;
+    op.font = font;
+    op.r = color_r_;
+    op.g = color_g_;
+    op.b = color_b_;
+    op.a = color_a_;
+    op.x = x + (kSplitScreen ? 0 : kSplitOffset);
+    op.y = y;
+    op.rect = {op.x, y, str_len_px, font->char_height};
+    op_sink_->push_back(op);
 
-    // Desenha o texto da versão.
-    draw_text(percent_field.font, x, y, version_str.c_str());
+    return y + char_height_;
 }
 
-/**
- * @brief Desenha a porcentagem de bateria na tela de carregamento.
- *
- * Esta função calcula dinamicamente a cor da porcentagem com base no nível
- * atual da bateria (escala de 0% a 100%), usando interpolação linear (gradiente)
- * entre cores predefinidas.
- *
- * @param anim Ponteiro para a estrutura 'animation' contendo o nível de carga e status.
- */
-void HealthdDraw::draw_percent(const animation* anim) {
-    // Retorna imediatamente se o sistema gráfico não estiver inicializado.
-    if (!graphics_available) return;
+void HealthdDraw::determine_xy(const animation::text_field& field, const int length, int* x,
+                               int* y) {
+    // The clock and percent texts this positions are digits but for a sign or two.
+    char sample[DrawOp::kMaxText] = {};
+    memset(sample, '0', std::clamp<int>(length, 0, sizeof(sample) - 1));
+    DrawRect rect = layout_text(field.font, field.pos_x, field.pos_y,
+                                measure_digits(field.font, sample));
+    *x = rect.x;
+    *y = rect.y;
+}
 
-    // Obtém o nível de carga atual.
-    int cur_level = anim->cur_level;
+int HealthdDraw::measure_digits(const GRFont* font, const char* sample) const {
+    if (font == nullptr) return 0;
+    char widest = '0';
+    int widest_width = 0;
+    for (char digit = '0'; digit <= '9'; digit++) {
+        const char text[] = {digit, '\0'};
+        int width = backend_->measure(font, text);
+        if (width > widest_width) {
+            widest = digit;
+            widest_width = width;
+        }
+    }
+    char text[DrawOp::kMaxText];
+    snprintf(text, sizeof(text), "%s", sample);
+    for (char* c = text; *c; c++) {
+        if (*c >= '0' && *c <= '9') *c = widest;
+    }
+    return backend_->measure(font, text);
+}
 
-    // Se o status for CARGA COMPLETA, força o nível para 100%.
-    if (anim->cur_status == BATTERY_STATUS_FULL) cur_level = 100;
-
-    // Se o nível for inválido (negativo), retorna.
-    if (cur_level < 0) return;
-
-    // Obtém o campo de texto configurado para a porcentagem.
-    const animation::text_field& field = anim->text_percent;
-    // Garante que a fonte esteja carregada.
-    if (field.font == nullptr) return;
-
-    // Estrutura para definir os pontos de cor na escala da bateria.
-    struct ColorPoint {
-        int level;
-        int r;
-        int g;
-        int b;
-    };
+int HealthdDraw::measure_run(void* context, const GRFont* font, const char* str) {
+    return static_cast<HealthdDraw*>(context)->backend_->measure(font, str);
+}
 
-    // Array estático de cores. O sistema fará interpolação entre esses pontos.
-    static const ColorPoint colors[] = {
-            {0, 255, 0, 0},     // Vermelho (0%)
-            {15, 255, 69, 0},   // Laranja-Avermelhado (15%)
-            {30, 255, 140, 0},  // Laranja-Escuro (30%)
-            {45, 255, 165, 0},  // Laranja (45%)
-            {50, 255, 255, 0},  // Amarelo (50%)
-            {65, 178, 255, 0},  // Verde-Limão Amarelado (65%)
-            {75, 127, 255, 0},  // Verde-Limão (75%)
-            {85, 76, 255, 0},   // Verde-Claro (85%)
-            {100, 0, 255, 0}    // Verde (100%)
-    };
+DrawRect HealthdDraw::layout_text(const GRFont* font, int pos_x, int pos_y, int width) const {
+    if (font == nullptr) return {0, 0, 0, 0};
+
+    DrawRect rect;
+    rect.w = width;
+    rect.h = font->char_height;
+    if (pos_x == CENTER_VAL) {
+        rect.x = (display_->screen_width - rect.w) / 2;
+    } else if (pos_x >= 0) {
+        rect.x = pos_x;
+    } else {  // position from max edge
+        rect.x = display_->screen_width + pos_x - rect.w - kSplitOffset;
+    }
 
-    // Variáveis para armazenar a cor final (interpolada).
-    int r = 0, g = 0, b = 0;
+    if (pos_y == CENTER_VAL) {
+        rect.y = (display_->screen_height - font->char_height) / 2;
+    } else if (pos_y >= 0) {
+        rect.y = pos_y;
+    } else {  // position from max edge
+        rect.y = display_->screen_height + pos_y - font->char_height;
+    }
+    return rect;
+}
 
-    // Itera pelos pontos de cor para encontrar o intervalo correto.
-    for (int i = 0; i < 8; i++) {
-        // Verifica se o nível atual está entre o ponto 'i' e o ponto 'i+1'.
-        if (cur_level >= colors[i].level && cur_level <= colors[i + 1].level) {
-            // Calcula o fator de interpolação (t) (de 0.0 a 1.0) dentro do intervalo.
-            float t = float(cur_level - colors[i].level) /
-                      float(colors[i + 1].level - colors[i].level);
+bool HealthdDraw::layout_current(const OrientationState& state, int fb_width,
+                                 int fb_height) const {
+    return state.layout_valid && state.layout_fb_width == fb_width &&
+           state.layout_fb_height == fb_height && state.layout_percent_font == percent_font_ &&
+           state.layout_clock_font == clock_font_;
+}
 
-            // Interpola linearmente a cor Vermelho (R).
-            r = colors[i].r + (int)((colors[i + 1].r - colors[i].r) * t);
+void HealthdDraw::ensure_layout(const animation* anim) {
+    Display& display = *display_;
+    const int fb_width = backend_->width();
+    const int fb_height = backend_->height();
+    if (!layout_current(display, fb_width, fb_height)) build_layout(anim, fb_width, fb_height);
+    if (!display.rotated || layout_current(display.parked, fb_height, fb_width)) return;
+
+    // A connector that rotates flips between two orientations a quarter turn
+    // apart, so the other one is the same framebuffer transposed. Lay it out and
+    // render its static layer now, so that rotating is only a swap.
+    OrientationState& current = display;
+    std::swap(current, display.parked);
+    build_layout(anim, fb_height, fb_width);
+    build_static_layer(anim);
+    std::swap(current, display.parked);
+}
 
-            // Interpola linearmente a cor Verde (G).
-            g = colors[i].g + (int)((colors[i + 1].g - colors[i].g) * t);
+void HealthdDraw::build_layout(const animation* anim, int fb_width, int fb_height) {
+    Display& display = *display_;
+    HEALTHD_PROFILE_STAGE(&profiler_, STAGE_LAYOUT);
+    display.layout_fb_width = fb_width;
+    display.layout_fb_height = fb_height;
+    display.layout_percent_font = percent_font_;
+    display.layout_clock_font = clock_font_;
+    display.screen_width = fb_width / (kSplitScreen ? 2 : 1);
+    display.screen_height = fb_height;
+    update_layout(anim);
+    display.layout_valid = true;
+    // Composing in bands needs a canvas, but only pays on a panel large enough
+    // for its frames to be split.
+    bool tiled = kRenderThreads > 1 &&
+                 static_cast<int64_t>(display.screen_width) * display.screen_height >=
+                         kMinTiledPixels;
+    if (kSplitScreen || num_displays_ > 1 || kRgb565 || tiled) {
+        display.canvas = raster_create(display.screen_width, display.screen_height,
+                                       kRgb565 ? 2 : sizeof(uint32_t));
+        if (!display.canvas) LOGE("Could not allocate canvas for connector %d\n", display.drm);
+    }
+    // Started here, not on the first frame that needs it, so frames never allocate.
+    if (tiled && display.canvas && !tile_pool_) {
+        tile_pool_ = std::make_unique<TilePool>(kRenderThreads);
+    }
+    // Everything cached against the old layout is stale now.
+    invalidate_static_layer();
+    display.full_redraw = true;
+}
 
-            // Interpola linearmente a cor Azul (B).
-            b = colors[i].b + (int)((colors[i + 1].b - colors[i].b) * t);
+void HealthdDraw::update_layout(const animation* anim) {
+    DrawList& list = display_->draw_list;
+    list.clear();
 
-            // Encerra o loop após encontrar e calcular a cor.
-            break;
+    const GRFont* fonts[] = {percent_font_, clock_font_, sys_font};
+    auto font_of = [&fonts](const ScreenElement* e) { return fonts[e->font]; };
+    auto is_static = [](const ScreenElement* e) {
+        return e->kind == ScreenElement::TEXT && e->color_source != ScreenElement::COLOR_GRADIENT;
+    };
+    // Texts drawn every frame are cached as glyph runs: make room for the
+    // longest one, the texts of the unknown-status screen included.
+    size_t run_bytes = 0;
+    auto fit_run = [&run_bytes](const GRFont* font, int width) {
+        size_t bytes = static_cast<size_t>(std::max(width, 0)) * font->char_height;
+        run_bytes = std::max(run_bytes, bytes);
+    };
+    if (sys_font) {
+        for (const char* text : kUnknownTexts) fit_run(sys_font, backend_->measure(sys_font, text));
+    }
+    auto color_of = [anim](const ScreenElement* e) {
+        if (e->color_source == ScreenElement::COLOR_CLOCK) {
+            const animation::text_field& clock = anim->text_clock;
+            return pack_element_color(clock.color_r, clock.color_g, clock.color_b, clock.color_a);
+        }
+        if (e->color_source == ScreenElement::COLOR_GRADIENT) {
+            // Only the alpha is fixed; the ramp supplies the rest.
+            return pack_element_color(0, 0, 0, anim->text_percent.color_a);
+        }
+        return pack_element_color(e->r, e->g, e->b, e->a);
+    };
+
+    // Constant texts first, then by font and color. Elements are not expected
+    // to overlap, so reordering them does not change the picture.
+    std::vector<const ScreenElement*> order;
+    order.reserve(screen_elements_.size());
+    for (const ScreenElement& element : screen_elements_) order.push_back(&element);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const ScreenElement* a, const ScreenElement* b) {
+                         if (is_static(a) != is_static(b)) return is_static(a);
+                         if (font_of(a) != font_of(b)) {
+                             return std::less<const GRFont*>()(font_of(a), font_of(b));
+                         }
+                         return color_of(a) < color_of(b);
+                     });
+
+    for (const ScreenElement* e : order) {
+        const GRFont* font = font_of(e);
+        if (font == nullptr || font->char_width == 0 || font->char_height == 0) continue;
+
+        const animation::text_field* x_field = e->x_anchor == ScreenElement::ANCHOR_PERCENT
+                                                       ? &anim->text_percent
+                                                       : &anim->text_clock;
+        const animation::text_field* y_field = e->y_anchor == ScreenElement::ANCHOR_PERCENT
+                                                       ? &anim->text_percent
+                                                       : &anim->text_clock;
+        int pos_x = e->x_anchor == ScreenElement::ANCHOR_VALUE ? e->x : x_field->pos_x;
+        int pos_y = e->y_anchor == ScreenElement::ANCHOR_VALUE ? e->y : y_field->pos_y;
+
+        // Dynamic texts are laid out as wide as any of their values can be drawn.
+        int widths[DrawList::kVariants];
+        switch (e->kind) {
+            case ScreenElement::PERCENT:
+                // "0%".."9%", "10%".."99%" and "100%".
+                widths[0] = measure_digits(font, "0%");
+                widths[1] = measure_digits(font, "00%");
+                widths[2] = measure_digits(font, "000%");
+                break;
+            case ScreenElement::CLOCK:
+                std::fill(std::begin(widths), std::end(widths),
+                          measure_digits(font, kClockTextSample));
+                break;
+            case ScreenElement::DATE:
+                std::fill(std::begin(widths), std::end(widths),
+                          measure_digits(font, kDateTextSample));
+                break;
+            case ScreenElement::CHARGE:
+                std::fill(std::begin(widths), std::end(widths),
+                          measure_digits(font, kChargeTextSample));
+                break;
+            default:
+                std::fill(std::begin(widths), std::end(widths), backend_->measure(font, e->text));
+                break;
+        }
+        if (!is_static(e)) fit_run(font, *std::max_element(std::begin(widths), std::end(widths)));
+        for (int width : widths) {
+            DrawRect rect = layout_text(font, pos_x, pos_y, width);
+            // Ops are recorded in half-screen coordinates in split-screen mode, and
+            // present_canvas() applies the offset.
+            rect.x += e->dx + (kSplitScreen ? 0 : kSplitOffset);
+            rect.y += e->dy + e->lines * font->char_height;
+            list.rect.push_back(rect);
         }
+        list.kind.push_back(e->kind);
+        list.font.push_back(font);
+        list.color_source.push_back(e->color_source == ScreenElement::COLOR_GRADIENT
+                                            ? ScreenElement::COLOR_GRADIENT
+                                            : ScreenElement::COLOR_FIXED);
+        list.color.push_back(color_of(e));
+        list.text.push_back(e->kind == ScreenElement::TEXT ? e->text : nullptr);
+        if (is_static(e)) list.static_count++;
     }
+    glyph_runs_.reserve(run_bytes);
 
-    // Formata o nível atual como uma string com o símbolo de porcentagem (ex: "50%").
-    std::string str = base::StringPrintf("%d%%", cur_level);
+    LOGV("layout rebuilt for %dx%d, %zu elements\n", display_->layout_fb_width,
+         display_->layout_fb_height, list.size());
+}
 
-    // Calcula a posição (X, Y) do texto com base no campo de alinhamento.
-    int x, y;
-    determine_xy(field, str.size(), &x, &y);
+void HealthdDraw::draw_elements(const animation* anim) {
+    HEALTHD_PROFILE_STAGE(&profiler_, STAGE_ELEMENTS);
+    const DrawList& list = display_->draw_list;
 
-    // Define a cor final interpolada (R, G, B) com opacidade total (A:255).
-    gr_color(r, g, b, field.color_a);
+    // Se o status for CARGA COMPLETA, força o nível para 100%.
+    int level = anim->cur_status == BATTERY_STATUS_FULL ? 100 : anim->cur_level;
+    // Texto da porcentagem já formatado para cada nível; nível inválido (negativo)
+    // não é desenhado.
+    static const PercentTexts kPercentTexts;
+    char percent_buffer[8] = {};
+    const char* percent = percent_buffer;
+    int percent_length = 0;
+    if (level >= 0 && level <= 100) {
+        percent = kPercentTexts.text[level];
+        percent_length = kPercentTexts.length[level];
+    } else if (level > 100) {
+        percent_length = snprintf(percent_buffer, sizeof(percent_buffer), "%d%%", level);
+    }
+    // Cor do gradiente para o nível atual: uma única leitura na tabela pré-calculada.
+    const GradientColor& gradient = percent_gradient_.at(level);
+
+    for (size_t i = list.static_count; i < list.size(); i++) {
+        const DrawRect* rect = &list.rect[i * DrawList::kVariants];
+        const char* text;
+        switch (list.kind[i]) {
+            case ScreenElement::PERCENT:
+                if (percent_length < 2 || percent_length > 4) continue;
+                text = percent;
+                rect += percent_length - 2;
+                break;
+            case ScreenElement::CLOCK:
+                mark_time_dependent();
+                if (frame_time_.clock_length != kClockTextLength) {
+                    LOGE("Could not format time\n");
+                    continue;
+                }
+                text = frame_time_.clock;
+                break;
+            case ScreenElement::DATE:
+                mark_time_dependent();
+                if (frame_time_.date_length != kDateTextLength) continue;
+                text = frame_time_.date;
+                break;
+            case ScreenElement::CHARGE:
+                // Taxa e tempo até a carga completa; vazio enquanto não há estimativa.
+                mark_charge_dependent();
+                if (frame_charge_.length != ChargeRateEstimator::kTextLength) continue;
+                text = frame_charge_.text;
+                break;
+            default:
+                text = list.text[i];
+                break;
+        }
 
-    // Desenha o texto da porcentagem na tela.
-    draw_text(field.font, x, y, str.c_str());
+        uint32_t rgba = list.color[i];
+        DrawOp op = {};
+        op.kind = DrawOp::TEXT;
+        op.font = list.font[i];
+        if (list.color_source[i] == ScreenElement::COLOR_GRADIENT) {
+            op.r = gradient.r;
+            op.g = gradient.g;
+            op.b = gradient.b;
+            // Em RGB565 o gradiente é pontilhado, para manter os tons intermediários.
+            op.dither = true;
+        } else {
+            op.r = rgba >> 24;
+            op.g = rgba >> 16;
+            op.b = rgba >> 8;
+        }
+        op.a = rgba;
+        // Todos os textos cabem na operação: os da lista são recusados na leitura
+        // quando não cabem.
+        static_assert(ScreenElement::kMaxText <= DrawOp::kMaxText &&
+                              kDateTextLength < DrawOp::kMaxText &&
+                              ChargeRateEstimator::kTextLength < DrawOp::kMaxText,
+                      "element texts must fit in a DrawOp");
+        snprintf(op.text, sizeof(op.text), "%s", text);
+        op.run = glyph_runs_.get(op.font, op.text);
+        op.x = rect->x;
+        op.y = rect->y;
+        op.rect = *rect;
+        op_sink_->push_back(op);
+    }
 }
 
 /**
@@ -437,18 +1738,23 @@ void HealthdDraw::draw_percent(const animation* anim) {
 void HealthdDraw::draw_battery(const animation* anim) {
     if (!graphics_available) return;
 
-    // 1. TOPO: Desenha o cabeçalho principal
-    draw_header(anim);
-
-    // 2. SUBCABEÇALHO: Desenha o subcabeçalho
-    draw_subheader(anim);
-
-    // 3. CENTRO: Desenha a porcentagem e a data (que está logo abaixo da porcentagem)
-    draw_percent(anim);
-    // draw_date(anim);
+    // 1, 2 e 4. TOPO, SUBCABEÇALHO e RODAPÉ: textos constantes da lista de elementos,
+    // desenhados uma única vez na camada estática, que passa a ser o fundo do quadro.
+    build_static_layer(anim);
+    display_->background = display_->static_layer.get();
+
+    // Quadro atual da animação, descomprimido sob demanda.
+    int shown;
+    GRSurface* frame = animation_frame(anim, anim->cur_frame, &shown);
+    if (frame != nullptr) {
+        draw_surface_centered(frame);
+        // A mesma superfície pode guardar outro quadro: o índice entra na comparação.
+        op_sink_->back().frame = shown;
+    }
 
-    // 4. RODAPÉ: Desenha a versão
-    draw_version(anim);
+    // 3. CENTRO: a porcentagem e os demais textos que mudam a cada quadro, numa
+    // única passada pela lista de elementos.
+    draw_elements(anim);
 }
 
 void HealthdDraw::draw_unknown(GRSurface* surf_unknown) {
@@ -456,9 +1762,9 @@ void HealthdDraw::draw_unknown(GRSurface* surf_unknown) {
     if (surf_unknown) {
         draw_surface_centered(surf_unknown);
     } else if (sys_font) {
-        gr_color(0xa4, 0xc6, 0x39, 255);
-        y = draw_text(sys_font, -1, -1, "Charging!");
-        draw_text(sys_font, -1, y + 25, "?\?/100");
+        set_color(0xa4, 0xc6, 0x39, 255);
+        y = draw_text(sys_font, -1, -1, kUnknownTexts[0]);
+        draw_text(sys_font, -1, y + 25, kUnknownTexts[1]);
     } else {
         LOGW("Charging, level unknown\n");
     }
@@ -469,5 +1775,11 @@ std::unique_ptr<HealthdDraw> HealthdDraw::Create(animation* anim) {
         LOGE("gr_init failed\n");
         return nullptr;
     }
-    return std::unique_ptr<HealthdDraw>(new HealthdDraw(anim));
+    return Create(anim, std::make_unique<MinuiDrawBackend>());
+}
+
+std::unique_ptr<HealthdDraw> HealthdDraw::Create(animation* anim,
+                                                 std::unique_ptr<HealthdDrawBackend> backend) {
+    if (backend == nullptr) return nullptr;
+    return std::unique_ptr<HealthdDraw>(new HealthdDraw(anim, std::move(backend)));
 }
@@ -20,7 +20,25 @@
 #include <linux/input.h>
 #include <minui/minui.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "animation.h"
+#include "healthd_draw_backend.h"
+#include "healthd_draw_clock.h"
+#include "healthd_draw_elements.h"
+#include "healthd_draw_frames.h"
+#include "healthd_draw_glyphs.h"
+#include "healthd_draw_governor.h"
+#include "healthd_draw_gradient.h"
+#include "healthd_draw_mailbox.h"
+#include "healthd_draw_profile.h"
+#include "healthd_draw_rate.h"
+#include "healthd_draw_runs.h"
+#include "healthd_draw_tiles.h"
 
 using namespace android;
 
@@ -33,19 +51,290 @@ class HealthdDraw {
 
   // According to the index of Direct Rendering Manager,
   // Blanks screen if true, unblanks if false.
+  // With several connectors, every unblanked one is drawn by redraw_screen().
   virtual void blank_screen(bool blank, int drm);
 
   // Rotate screen.
+  // With several connectors only connector |drm| is rotated, landscape for 0
+  // and portrait otherwise; the others keep their orientation and layout.
   virtual void rotate_screen(int drm);
 
   // Detect dual display
   virtual bool has_multiple_connectors();
+  // Connectors drawn to, each keeping its own layout, orientation and buffers.
+  int connector_count() const { return num_displays_; }
+
+  // timerfd that fires when the displayed minute rolls over, for the charger's
+  // epoll loop; -1 if unavailable. When it fires, call handle_clock_event() and
+  // redraw if it returns true.
+  int clock_fd() const { return clock_.fd(); }
+  bool handle_clock_event();
+
+  // eventfd that becomes readable once the fonts loading in the background are
+  // ready; -1 if nothing loads in the background. When it fires, call
+  // handle_font_event() and redraw if it returns true.
+  int font_fd() const { return font_event_fd_.get(); }
+  bool handle_font_event();
+
+  struct StartupStats {
+    // Time from construction until the first frame was presented, and until the
+    // clock and percent fonts were ready; 0 until then.
+    int64_t first_frame_ns;
+    int64_t fonts_ready_ns;
+    // Fonts mapped from a glyph cache instead of decoded from PNG.
+    int fonts_from_cache;
+    // The first frame was drawn with the system font while fonts were loading.
+    bool first_frame_fallback;
+  };
+  // Safe to call while the render thread runs.
+  StartupStats startup_stats() const;
 
+  // Takes the surfaces of anim->frames: they are compressed, freed and set to
+  // nullptr, unless any of them cannot be compressed, in which case they stay
+  // the caller's and are drawn as they are.
   static std::unique_ptr<HealthdDraw> Create(animation *anim);
+  // Draws through |backend| instead of minui, e.g. a MemoryDrawBackend on a host.
+  static std::unique_ptr<HealthdDraw> Create(animation* anim,
+                                             std::unique_ptr<HealthdDrawBackend> backend);
+
+  HealthdDrawBackend* backend() const { return backend_.get(); }
+
+  // Cost of the last frame presented on a connector, for measuring partial updates.
+  struct FrameStats {
+    bool full_redraw;
+    int damage_rects;
+    int64_t pixels_cleared;
+    int64_t pixels_painted;
+    // Approximate framebuffer bytes written by clearing and painting.
+    int64_t bytes_written;
+    // Horizontal bands the damage was composed in, in parallel if more than one.
+    int bands;
+  };
+  const FrameStats& last_frame_stats(int drm = 0) const { return display_for(drm).frame_stats; }
+
+  // How many redraw_screen() calls were presented, and how many were skipped
+  // because nothing visible had changed since the last presented frame.
+  struct FrameCounters {
+    int64_t presented;
+    int64_t elided;
+  };
+  const FrameCounters& frame_counters() const { return frame_counters_; }
+
+  // Hits and misses of the cache of rasterized texts; stable once the render
+  // thread is stopped.
+  const GlyphRunCache::Stats& glyph_run_stats() const { return glyph_runs_.stats(); }
+
+  // redraw_screen() goes through a frame-rate governor: visible changes are drawn
+  // at once, an animation runs at full rate, a steady screen is redrawn rarely
+  // and even more rarely while throttled, and nothing is drawn while every
+  // connector is blanked. Refused calls return without drawing.
+  //
+  // Battery temperature in tenths of a degree Celsius, for throttling.
+  void set_battery_temperature(int temperature) { battery_temperature_ = temperature; }
+  // Milliseconds until the governor would let an unchanged frame through, for the
+  // charger's epoll timeout; -1 while stopped.
+  int next_redraw_ms() const;
+  // The governor's current mode and why, its counters and the frames drawn in
+  // the last minute.
+  FrameGovernor::Stats governor_stats();
+
+  // Charge rate and time to full estimated from the levels drawn so far.
+  const ChargeRateEstimator::Estimate& charge_estimate() const { return charge_.estimate(); }
+
+  // Memory held by the battery animation frames, compressed and decoded, once
+  // any frame being prefetched is decoded.
+  AnimationFrameStore::Stats frame_store_stats();
+
+  // Moves rendering and flipping to a dedicated thread, so a slow flip no longer
+  // holds up the caller's event loop. redraw_screen(), blank_screen() and
+  // rotate_screen() then only publish the requested state and return; the thread
+  // renders the latest state and skips any it did not get to. |anim| supplies the
+  // fonts and text fields, which must not change afterwards.
+  // last_frame_stats() and frame_counters() are only stable once stopped.
+  bool start_render_thread(const animation* anim);
+  void stop_render_thread();
+
+  struct RenderThreadStats {
+    // States published by the caller, rendered by the thread, and replaced by a
+    // newer one before the thread got to them.
+    int64_t published;
+    int64_t rendered;
+    int64_t coalesced;
+    // Longest time a publishing call blocked the caller.
+    int64_t max_publish_ns;
+    // Longest time from publishing a state to having it presented.
+    int64_t max_present_latency_ns;
+  };
+  RenderThreadStats render_thread_stats() const;
+
+  // Asks for the frame profile to be dumped at the next redraw. Only sets a flag,
+  // so it is safe to call from a signal handler. The dump goes to the files
+  // <prefix>.txt and <prefix>.bin if debug.charger.frame_profile names a prefix,
+  // else as text to kmsg. Needs a build with HEALTHD_DRAW_PROFILING, where
+  // SIGUSR1 calls it too unless the process already handled or ignored that
+  // signal when the first HealthdDraw was created, e.g. "kill -USR1 <charger>".
+  static void request_profile_dump();
+  // Writes the per-stage histograms and the last frames to whichever of |text|
+  // and |binary| is not null.
+  bool dump_profile(FILE* text, FILE* binary) const;
 
  protected:
+  // A single paint command recorded while building a frame. The draw_* functions
+  // record ops instead of painting directly, so that compute_damage() can diff them
+  // against the previous frame and only repaint what changed.
+  struct DrawOp {
+    enum Kind { TEXT, SURFACE } kind;
+    const GRFont* font;
+    GRSurface* surface;
+    // Animation frame |surface| holds, or -1: frame store slots are reused for
+    // other frames, so the surface alone does not tell frames apart.
+    int frame;
+    int x, y;
+    unsigned char r, g, b, a;
+    // Dithered when painted into an RGB565 canvas.
+    bool dither;
+    static constexpr size_t kMaxText = GlyphRun::kMaxText;
+    char text[kMaxText];
+    // |text| rasterized, painted in one pass per row; null if it is painted
+    // glyph by glyph. Derived from font and text, so not compared.
+    const GlyphRun* run;
+    // Screen area touched when this op is painted.
+    DrawRect rect;
+
+    bool operator==(const DrawOp& o) const;
+  };
+
+  // Front buffers are recycled by gr_flip(); the back buffer holds the frame from
+  // this many flips ago, so damage is accumulated over that many frames.
+  static constexpr int kBufferAge = 2;
+  // Beyond this many rectangles the damage list collapses into its bounding box.
+  static constexpr size_t kMaxDamageRects = 8;
+  // Ops a frame usually records at most. Op and damage lists are reserved up
+  // front, so frames after the first one draw without allocating.
+  static constexpr size_t kMaxFrameOps = 32;
+  static constexpr int kMaxConnectors = 2;
+  // Frames are composed by this many threads at most. Damage smaller than
+  // kMinTiledPixels is composed on the drawing thread alone, as waking the others
+  // would cost more than it saves. Otherwise it is cut into bands of at least
+  // kMinBandRows rows, a few per thread so that uneven bands even out.
+  static constexpr int kMaxRenderThreads = 8;
+  static constexpr int64_t kMinTiledPixels = 256 * 1024;
+  static constexpr int kMinBandRows = 32;
+  static constexpr int kBandsPerThread = 4;
+
+  // Everything redraw_screen()'s output depends on, besides the layout inputs
+  // and the rotation, which invalidate() on their own.
+  struct FrameKey {
+    bool unknown;
+    int level;
+    int status;
+    // Animation frame shown, or -1 if there is none.
+    int frame;
+    const GRSurface* surf_unknown;
+    // clock_ generation, only set when the frame shows the time, and charge_
+    // text generation, only set when it shows the charge readout.
+    uint64_t minute;
+    uint64_t charge;
+
+    bool operator==(const FrameKey& o) const {
+      return unknown == o.unknown && level == o.level && status == o.status &&
+             frame == o.frame && surf_unknown == o.surf_unknown && minute == o.minute &&
+             charge == o.charge;
+    }
+  };
+
+  // Everything laid out and cached for one orientation of a connector: its
+  // layout, its layers and the frame it last showed.
+  struct OrientationState {
+    // Width and height of the area laid out, in pixels: the screen, or one half
+    // of it in split-screen mode.
+    int screen_width = 0;
+    int screen_height = 0;
+    // Screen elements compiled against this layout; elements whose font is
+    // missing are left out. Only rebuilt by update_layout().
+    DrawList draw_list;
+    // Inputs the layout table was built from.
+    bool layout_valid = false;
+    int layout_fb_width = 0;
+    int layout_fb_height = 0;
+    const GRFont* layout_percent_font = nullptr;
+    const GRFont* layout_clock_font = nullptr;
+
+    // Constant texts pre-rendered over black. Dropped whenever the layout changes.
+    std::unique_ptr<GRSurface> static_layer;
+    // Offscreen buffer frames are composed in when they cannot be drawn straight
+    // to the screen: the half-screen in split-screen mode, and the whole screen
+    // when there are several connectors. It is ours, so it survives blanking and
+    // a connector shown again only needs it copied back.
+    std::unique_ptr<GRSurface> canvas;
+
+    // Ops and background of the last presented frame; nullptr means plain black.
+    std::vector<DrawOp> last_ops;
+    GRSurface* last_background = nullptr;
+    FrameKey last_frame_key = {};
+    // Whether the last presented frame shows the time, and the charge readout.
+    bool last_frame_uses_time = false;
+    bool last_frame_uses_charge = false;
+    // Next frame must be repainted in full.
+    bool full_redraw = true;
+  };
+
+  // Everything kept per connector: its orientation, the state of the
+  // orientation shown and of the other one, and the buffers frames are built in.
+  // Connectors are brought up to date independently, so switching between them
+  // leaves both warm.
+  struct Display : OrientationState {
+    int drm = 0;
+    // Set once rotate_screen() picked an orientation; until then minui's
+    // default rotation is left alone.
+    bool rotated = false;
+    GRRotation rotation = GRRotation::NONE;
+    bool blanked = false;
+    // The other orientation, kept while this one is shown, so rotating back
+    // swaps it in instead of laying out and rasterizing again.
+    OrientationState parked;
+
+    // Ops recorded for the frame being built, and its background.
+    std::vector<DrawOp> frame_ops;
+    GRSurface* background = nullptr;
+    // Damage of the frame being built, the part of it this frame caused itself,
+    // and the damage of the previous kBufferAge - 1 frames.
+    std::vector<DrawRect> damage;
+    std::vector<DrawRect> own_damage;
+    std::vector<DrawRect> damage_history[kBufferAge - 1];
+    // Screen damage flipped for the frame being presented.
+    std::vector<DrawRect> present_damage;
+    // Canvas rects present_canvas() copies to the screen.
+    std::vector<DrawRect> present_copy;
+
+    // The canvas is current but the screen must be refreshed from all of it.
+    bool present_full = false;
+    // The frame being presented was repainted, not only copied from the canvas.
+    bool repaint = false;
+    FrameStats frame_stats = {};
+  };
+
   virtual void clear_screen();
 
+  // Sets the color used by subsequently recorded ops.
+  void set_color(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+  // Forces the next frames to be repainted in full on every connector.
+  void invalidate();
+  // Marks the frame being built as showing the time, so the next frames are
+  // redrawn when the minute changes.
+  void mark_time_dependent() { frame_uses_time_ = true; }
+  // Likewise for the charge readout, redrawn when its text changes.
+  void mark_charge_dependent() { frame_uses_charge_ = true; }
+  // Presents |count| displays' frames together. Each one's present_damage lists
+  // the regions that differ from its previous frame.
+  virtual void flip(Display* const* displays, int count);
+
+  // Renders the constant texts of display_'s draw list once into an offscreen
+  // layer that then serves as the background of battery frames.
+  void build_static_layer(const animation* anim);
+  // Drops the static layer; it is rebuilt on the next battery frame.
+  void invalidate_static_layer();
+
   // returns the last y-offset of where the surface ends.
   virtual int draw_surface_centered(GRSurface* surface);
   // Negative x or y coordinates center text.
@@ -56,62 +345,76 @@ class HealthdDraw {
   virtual void determine_xy(const animation::text_field& field,
                             const int length, int* x, int* y);
 
+  // Rebuilds display_'s layout table if the screen size or a font changed since it was
+  // last built, and once display_ was rotated, keeps its other orientation laid
+  // out too. Cheap when nothing changed.
+  void ensure_layout(const animation* anim);
+  // Compiles screen_elements_ into display_'s draw list, resolving every
+  // element's final rectangle.
+  virtual void update_layout(const animation* anim);
+  // Resolves a text |width| pixels wide in |font| positioned at (pos_x, pos_y),
+  // using the same rules as determine_xy().
+  DrawRect layout_text(const GRFont* font, int pos_x, int pos_y, int width) const;
+  // Width of |sample| in |font| with every digit replaced by the font's widest,
+  // so that any text differing from it only in its digits fits.
+  int measure_digits(const GRFont* font, const char* sample) const;
+  // GlyphRunCache::MeasureFunction measuring with backend_.
+  static int measure_run(void* context, const GRFont* font, const char* str);
+
+  // Moves the animation's frames into frame_store_, compressed, freeing each
+  // surface as soon as it is, so the decoded frames and the compressed ones are
+  // never all held at once; frames are then drawn from the store. Leaves the
+  // store empty, and the surfaces alone, if any cannot be compressed. Frames
+  // beyond ro.charger.frame_budget_kb are then dropped as fit_budget() says.
+  void adopt_animation_frames(animation* anim);
+  // Decoded surface of animation frame |index|, or nullptr; |*shown| is set to
+  // the frame it holds, which a budget-bound store may substitute.
+  GRSurface* animation_frame(const animation* anim, int index, int* shown);
+
   // Draws battery animation, if it exists.
   virtual void draw_battery(const animation* anim);
-  // Draws clock text, if animation contains text_field data.
-  virtual void draw_clock(const animation* anim);
-  // Draws battery percentage text if animation contains text_field data.
-  virtual void draw_percent(const animation* anim);
   // Draws charger->surf_unknown or basic text.
   virtual void draw_unknown(GRSurface* surf_unknown);
+  // Records the texts of display_'s draw list that change from frame to frame,
+  // in one pass over the list.
+  void draw_elements(const animation* anim);
 
-/**
-   * @brief Desenha a data e hora atuais do sistema.
-   *
-   * Obtém e formata a data/hora, posicionando-a abaixo da porcentagem de bateria.
-   * A cor do texto varia com base no campo de porcentagem.
-   *
-   * @param anim Estrutura de dados da animação.
-   */
-  virtual void draw_date(const animation* anim);
-  
-  /**
-   * @brief Desenha o cabeçalho principal no topo da tela (Ex: DevTITANS).
-   *
-   * Posicionado no topo da tela, usando a cor Verde.
-   *
-   * @param anim Estrutura de dados da animação.
-   */
-  virtual void draw_header(const animation* anim);
-
-  /**
-   * @brief Desenha o subcabeçalho logo abaixo do cabeçalho principal (Ex: 2025/1).
-   *
-   * Posicionado logo abaixo do header e usando a cor Vermelha.
-   *
-   * @param anim Estrutura de dados da animação.
-   */
-  virtual void draw_subheader(const animation* anim); // NOVO MÉTODO ADICIONADO
-
-  /**
-   * @brief Desenha a versão do software no rodapé (bottom) da tela, usando a cor Azul.
-   *
-   * @param anim Estrutura de dados da animação.
-   */
-  virtual void draw_version(const animation* anim);
+  // Fonts of the clock and percent fields for the frame being built: the
+  // animation's own, the ones loaded in the background, or sys_font while those
+  // are loading. nullptr if the field has no usable font.
+  const GRFont* clock_font_ = nullptr;
+  const GRFont* percent_font_ = nullptr;
 
   // Pixel sizes of characters for default font.
   int char_width_;
   int char_height_;
 
-  // Width and height of screen in pixels.
-  int screen_width_;
-  int screen_height_;
+  // One display per connector, and the one the frame is being built for, which
+  // the draw_* functions lay out against.
+  Display displays_[kMaxConnectors];
+  int num_displays_ = 1;
+  Display* display_ = &displays_[0];
+
+  // Battery animation frames, decoded on demand within a memory budget.
+  AnimationFrameStore frame_store_;
+
+  // Percent text color for each level 0..100, baked once at construction.
+  GradientLut percent_gradient_;
+
+  // What the battery screen shows, from the screen description or the
+  // built-in defaults.
+  std::vector<ScreenElement> screen_elements_;
 
   // Device screen is split vertically.
   const bool kSplitScreen;
   // Pixels to offset graphics towards center split.
   const int kSplitOffset;
+  // Frames, cached layers and decoded animation frames are RGB565, and every
+  // display is composed offscreen so the framebuffer only sees finished frames.
+  const bool kRgb565;
+  // Threads composing each frame, the drawing thread included. With more than
+  // one, every display is composed offscreen, where bands can be drawn apart.
+  const int kRenderThreads;
 
   // system text font, may be nullptr
   const GRFont* sys_font;
@@ -120,8 +423,205 @@ class HealthdDraw {
   bool graphics_available;
 
  private:
+  // Display of connector |drm|; the only one if there is a single connector.
+  Display& display_for(int drm);
+  const Display& display_for(int drm) const;
+  // Points the backend and the draw_* functions at |display|. Returns false if
+  // its connector cannot be drawn to right now.
+  bool select_display(Display* display);
+
+  // Area display_'s ops are composed in: the screen, or one half of it in
+  // split-screen mode.
+  DrawRect canvas_rect() const;
+  DrawRect clip_to_canvas(const DrawRect& rect) const;
+  void add_damage(const DrawRect& rect);
+  // Diffs display_'s recorded ops against its previous frame to find the
+  // regions to repaint.
+  void compute_damage();
+  // Clears and repaints the damaged regions of each display. Those composed
+  // offscreen are painted concurrently.
+  void paint_displays(Display* const* displays, int count);
+  // Paints one display; only touches the backend if it has no canvas. Stages
+  // are timed into |profiler| unless it is nullptr. If |tiled|, large damage
+  // is composed in bands on tile_pool_.
+  void paint_display(Display* display, PixelFormat format, FrameProfiler* profiler,
+                     bool tiled);
+  // How many bands display's damage is composed in, and the rows [*top, *bottom)
+  // they split between them; 1 if it is composed on one thread.
+  int plan_bands(const Display& display, int* top, int* bottom) const;
+  // Clears, and repaints, the damage of |display| within rows [y1, y2).
+  void clear_rows(Display* display, PixelFormat format, int y1, int y2);
+  void paint_rows(Display* display, PixelFormat format, int y1, int y2);
+  // One frame's bands, handed to tile_pool_.
+  struct BandJob {
+    HealthdDraw* draw;
+    Display* display;
+    PixelFormat format;
+    int top;
+    int bottom;
+    int rows;
+  };
+  // TilePool task composing band |band| of the BandJob |job|.
+  static void paint_band(void* job, int band);
+  // Copies |source| to display's screen or canvas; 32-bit sources are packed for
+  // |format|. A canvas only has rows [y1, y2) written.
+  void canvas_blit(Display* display, const GRSurface* source, int sx, int sy, int w, int h,
+                   int dx, int dy, PixelFormat format, int y1 = 0, int y2 = INT_MAX);
+  void canvas_fill_black(Display* display, const DrawRect& rect, PixelFormat format);
+  // Drawing color last set while painting, so runs of texts in one color set it
+  // only once.
+  struct PaintState {
+    bool valid = false;
+    uint32_t rgba = 0;
+    // rgba packed for the canvas.
+    uint32_t pixel = 0;
+  };
+  void paint_op(Display* display, const DrawOp& op, PixelFormat format, PaintState* state,
+                int y1, int y2);
+  // Whether |state| was laid out for a framebuffer of this size and the current
+  // fonts.
+  bool layout_current(const OrientationState& state, int fb_width, int fb_height) const;
+  // Lays display_'s current orientation out for a framebuffer of this size and
+  // allocates its canvas.
+  void build_layout(const animation* anim, int fb_width, int fb_height);
+
+  // Paints the displays paint_displays() hands over while the calling thread
+  // paints its own, and decodes the animation frame present_frame() asks it to
+  // prefetch. Started on first use and kept, so frames start no threads.
+  void paint_helper_loop();
+  void start_paint_helper();
+  void stop_paint_helper();
+  // Waits until the frame prefetch_frame_ asked for is decoded; frame_store_ is
+  // only touched after this.
+  void wait_prefetch();
+  // Brings each display's screen up to date with its frame and flips them all.
+  void present_displays(Display* const* displays, int count);
+  // Copies the damaged parts of display_'s canvas to the screen, into both halves
+  // in split-screen mode.
+  void present_canvas();
+
+  // Renders and presents one frame showing |time| and |charge|, unless it would
+  // not differ from the last presented one, and profiles it.
+  void render_frame(const animation* batt_anim, GRSurface* surf_unknown,
+                    const ChargerClock::Texts& time, const ChargeRateEstimator::Text& charge);
+  // Returns false if the frame was skipped as unchanged.
+  bool present_frame(const animation* batt_anim, GRSurface* surf_unknown,
+                     const ChargerClock::Texts& time, const ChargeRateEstimator::Text& charge);
+  void dump_requested_profile();
+  void apply_blank(bool blank, int drm);
+  void apply_rotation(int drm);
+
+  // Color set by set_color(), captured by each recorded op.
+  unsigned char color_r_ = 255, color_g_ = 255, color_b_ = 255, color_a_ = 255;
+
+  // Where draw_text()/draw_surface_centered() record to; display_'s frame_ops
+  // unless the static layer is being built.
+  std::vector<DrawOp>* op_sink_ = nullptr;
+
+  // Clock and date texts, reformatted once per minute, and the ones the frame
+  // being built shows.
+  ChargerClock clock_;
+  ChargerClock::Texts frame_time_ = {};
+
+  // Whether the frame being built shows the time.
+  bool frame_uses_time_ = false;
+
+  // Charge rate estimated from the levels redraw_screen() is given, the readout
+  // the frame being built shows, and whether it shows it.
+  ChargeRateEstimator charge_;
+  ChargeRateEstimator::Text frame_charge_ = {};
+  bool frame_uses_charge_ = false;
+
+  // Dynamic texts rasterized by earlier frames, shared by every display. Only
+  // the thread recording frames looks runs up; painting only reads them.
+  GlyphRunCache glyph_runs_;
+
+  std::thread paint_helper_;
+  std::mutex paint_mutex_;
+  std::condition_variable paint_cv_;
+  // Displays handed to paint_helper_, and the format to paint them in; busy
+  // until it painted them all.
+  Display* paint_jobs_[kMaxConnectors] = {};
+  int paint_job_count_ = 0;
+  PixelFormat paint_format_ = PixelFormat::UNKNOWN;
+  bool paint_busy_ = false;
+  bool paint_exit_ = false;
+  // Animation frame paint_helper_ is to decode into frame_store_, or -1; busy
+  // until it is decoded.
+  int prefetch_frame_ = -1;
+  bool prefetch_busy_ = false;
+  // Composes large damage in bands when kRenderThreads > 1; started along with
+  // the first canvas large enough to be split.
+  std::unique_ptr<TilePool> tile_pool_;
+  FrameCounters frame_counters_ = {};
+  FrameProfiler profiler_;
+
+  // Graphics stack everything is drawn through.
+  std::unique_ptr<HealthdDrawBackend> backend_;
+
+  // Everything the render thread needs to bring the screen up to date.
+  struct RenderState {
+    // Whether redraw_screen() was called yet, and its arguments.
+    bool has_frame;
+    int level;
+    int status;
+    int num_frames;
+    int cur_frame;
+    GRSurface* surf_unknown;
+    ChargerClock::Texts time;
+    ChargeRateEstimator::Text charge;
+    // Last blank_screen() per connector: -1 never called, else 0 or 1.
+    int8_t blank[kMaxConnectors];
+    // Last rotate_screen() argument, and how many calls there were.
+    int rotate_drm;
+    uint64_t rotate_seq;
+    // steady_clock time of publishing.
+    int64_t published_ns;
+  };
+  enum FontSlot { FONT_CLOCK, FONT_PERCENT, FONT_COUNT };
+  // Maps cached fonts right away and decodes the others on font_thread_.
+  void start_font_loading(const animation* anim);
+  void load_fonts(const std::string (&names)[FONT_COUNT]);
+  // Sets clock_font_ and percent_font_ for the frame being built.
+  void resolve_fonts(const animation* anim);
+
+  std::thread font_thread_;
+  std::atomic<bool> fonts_ready_{false};
+  // Whether fonts_ready_ was seen and font_thread_ joined.
+  bool fonts_adopted_ = false;
+  // Written by font_thread_ only before fonts_ready_ is set.
+  const GRFont* loaded_fonts_[FONT_COUNT] = {};
+  std::unique_ptr<MappedGlyphFont> mapped_fonts_[FONT_COUNT];
+  android::base::unique_fd font_event_fd_;
+  int64_t created_ns_;
+  // Written by the thread recording frames, read by startup_stats() from any.
+  mutable std::mutex startup_mutex_;
+  StartupStats startup_stats_ = {};
+
+  // Whether the frame redraw_screen() was asked for may be drawn now.
+  bool admit_frame(const animation* batt_anim, int64_t now_ns);
+
+  FrameGovernor governor_;
+  int battery_temperature_ = INT_MIN;
+  // Connectors last blanked through blank_screen(), one bit each.
+  unsigned blanked_mask_ = 0;
+  FrameGovernor::Mode governor_mode_ = FrameGovernor::MODE_COUNT;
+
+  // Hands requested_ to the render thread; |start_ns| is when the call began.
+  void publish_requested(int64_t start_ns);
+  void render_loop();
+
+  std::thread render_thread_;
+  FrameMailbox<RenderState> mailbox_;
+  // State the caller last requested; only touched by the caller's thread.
+  RenderState requested_ = {};
+  // Copy of the caller's animation the render thread draws from.
+  animation render_anim_;
+  std::atomic<int64_t> max_publish_ns_{0};
+  std::atomic<int64_t> max_present_latency_ns_{0};
+
   // Configures font using given animation.
-  HealthdDraw(animation* anim);
+  HealthdDraw(animation* anim, std::unique_ptr<HealthdDrawBackend> backend);
 };
 
 #endif  // HEALTHD_DRAW_H
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_BACKEND_H
+#define HEALTHD_DRAW_BACKEND_H
+
+#include <minui/minui.h>
+
+#include <algorithm>
+#include <vector>
+
+// Rectangle in framebuffer pixels.
+struct DrawRect {
+    int x, y, w, h;
+
+    bool empty() const { return w <= 0 || h <= 0; }
+    bool intersects(const DrawRect& o) const {
+        return !empty() && !o.empty() && x < o.x + o.w && o.x < x + w && y < o.y + o.h &&
+               o.y < y + h;
+    }
+    bool contains(const DrawRect& o) const {
+        return o.x >= x && o.y >= y && o.x + o.w <= x + w && o.y + o.h <= y + h;
+    }
+    // The part of this rectangle inside |o|; empty if they do not overlap.
+    DrawRect intersection(const DrawRect& o) const {
+        int x1 = std::max(x, o.x);
+        int y1 = std::max(y, o.y);
+        int x2 = std::min(x + w, o.x + o.w);
+        int y2 = std::min(y + h, o.y + o.h);
+        return {x1, y1, std::max(x2 - x1, 0), std::max(y2 - y1, 0)};
+    }
+    bool operator==(const DrawRect& o) const {
+        return x == o.x && y == o.y && w == o.w && h == o.h;
+    }
+};
+
+// Everything HealthdDraw needs from a graphics stack. The device uses minui
+// (see HealthdDraw::Create); tests and profiling on a host can plug in an
+// in-memory framebuffer instead (healthd_draw_memory.h).
+//
+// Coordinates are in the current orientation, like minui after gr_rotate().
+class HealthdDrawBackend {
+  public:
+    virtual ~HealthdDrawBackend() {}
+
+    // Size of the drawable area in the current orientation.
+    virtual int width() = 0;
+    virtual int height() = 0;
+    virtual PixelFormat pixel_format() = 0;
+
+    // Device screen is split vertically, and pixels to offset graphics towards
+    // the center split.
+    virtual bool split_screen() = 0;
+    virtual int split_offset() = 0;
+    // Threads that compose frames in horizontal bands, the drawing thread
+    // included; 1 composes on the drawing thread alone.
+    virtual int render_threads() { return 1; }
+
+    // See the gr_* function of the same name.
+    virtual const GRFont* sys_font() = 0;
+    virtual int init_font(const char* name, GRFont** dest) = 0;
+    virtual int measure(const GRFont* font, const char* str) = 0;
+    virtual void color(unsigned char r, unsigned char g, unsigned char b, unsigned char a) = 0;
+    virtual void clear() = 0;
+    virtual void fill(int x1, int y1, int x2, int y2) = 0;
+    virtual void text(const GRFont* font, int x, int y, const char* str, bool bold) = 0;
+    // Blends |mask|, one byte of coverage per pixel, in the current color. Like
+    // gr_texticon(), draws nothing unless the whole mask fits.
+    virtual void text_mask(const GRSurface* mask, int x, int y) = 0;
+    // |source| may also be RGB565 (see healthd_draw_raster.h); it is then converted
+    // to the framebuffer's format on the way, unless the panel is RGB565 itself.
+    virtual void blit(const GRSurface* source, int sx, int sy, int w, int h, int dx, int dy) = 0;
+    // The framebuffer is RGB565, so RGB565 frames are copied without conversion.
+    virtual bool native_rgb565() { return false; }
+
+    // Presents the frame; |damage| lists the regions that changed since the
+    // previous one.
+    virtual void flip(const std::vector<DrawRect>& damage) = 0;
+    virtual void blank(bool blank, int drm) = 0;
+    virtual void rotate(GRRotation rotation) = 0;
+    virtual bool has_multiple_connectors() = 0;
+
+    // Connectors that can be drawn to, each with its own framebuffers and
+    // orientation.
+    virtual int connector_count() { return has_multiple_connectors() ? 2 : 1; }
+    // Directs drawing, width(), height(), rotate() and flip() to connector |drm|.
+    // Returns false if it cannot be drawn to right now.
+    virtual bool select_connector(int drm) { return drm == 0; }
+    // Presents the frames drawn on several connectors together; |damage|[i]
+    // belongs to connector |drms|[i]. By default they are flipped in turn.
+    virtual void flip_connectors(const int* drms, const std::vector<DrawRect>* const* damage,
+                                 int count) {
+        for (int i = 0; i < count; i++) {
+            if (select_connector(drms[i])) flip(*damage[i]);
+        }
+    }
+};
+
+#endif  // HEALTHD_DRAW_BACKEND_H
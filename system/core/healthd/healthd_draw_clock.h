@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_CLOCK_H
+#define HEALTHD_DRAW_CLOCK_H
+
+#include <android-base/unique_fd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+// Clock and date texts of the charger screen, formatted once per minute
+// instead of calling localtime()/strftime() on every frame.
+//
+// A CLOCK_REALTIME timerfd is armed for the next minute boundary. The charger
+// registers fd() with its epoll loop and calls on_timer() when it fires, which
+// lets the clock wake the loop exactly when the displayed minute changes.
+// Setting the wall clock cancels the timer, which is handled the same way.
+class ChargerClock {
+  public:
+    static constexpr size_t kTextCapacity = 16;
+
+    // The formatted texts of one minute. Plain data, so a copy can be handed to
+    // another thread.
+    struct Texts {
+        // "%H:%M" and "%d/%m/%Y"; empty if formatting failed.
+        char clock[kTextCapacity];
+        char date[kTextCapacity];
+        size_t clock_length;
+        size_t date_length;
+        // Increments every time the texts change.
+        uint64_t generation;
+    };
+
+    ChargerClock() {
+        fd_.reset(timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC));
+        refresh(now());
+    }
+
+    // Becomes readable at each minute boundary; -1 if timerfd is unavailable,
+    // in which case update() alone keeps the texts current.
+    int fd() const { return fd_.get(); }
+
+    // Handles the timerfd firing. Returns true if the texts changed.
+    bool on_timer() {
+        uint64_t expirations;
+        // Drains the expiration count, or the ECANCELED of a wall clock change.
+        if (fd_.get() >= 0) {
+            (void)TEMP_FAILURE_RETRY(read(fd_.get(), &expirations, sizeof(expirations)));
+        }
+        return refresh(now());
+    }
+
+    // Refreshes the texts if a minute boundary passed since they were formatted.
+    // Costs one clock read otherwise. Returns true if the texts changed.
+    bool update() {
+        time_t t = now();
+        if (t >= minute_start_ && t < minute_start_ + 60) return false;
+        return refresh(t);
+    }
+
+    // Texts of the current minute.
+    const Texts& texts() const { return texts_; }
+
+  private:
+    static time_t now() {
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return ts.tv_sec;
+    }
+
+    bool refresh(time_t t) {
+        minute_start_ = t - t % 60;
+
+        tm time_info;
+        char clock_text[kTextCapacity];
+        char date_text[kTextCapacity];
+        size_t clock_length = 0, date_length = 0;
+        if (localtime_r(&t, &time_info) != nullptr) {
+            clock_length = strftime(clock_text, sizeof(clock_text), "%H:%M", &time_info);
+            date_length = strftime(date_text, sizeof(date_text), "%d/%m/%Y", &time_info);
+        }
+        clock_text[clock_length] = '\0';
+        date_text[date_length] = '\0';
+
+        if (fd_.get() >= 0) {
+            itimerspec spec = {};
+            spec.it_value.tv_sec = minute_start_ + 60;
+            timerfd_settime(fd_.get(), TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec,
+                            nullptr);
+        }
+
+        if (strcmp(clock_text, texts_.clock) == 0 && strcmp(date_text, texts_.date) == 0) {
+            return false;
+        }
+        memcpy(texts_.clock, clock_text, clock_length + 1);
+        memcpy(texts_.date, date_text, date_length + 1);
+        texts_.clock_length = clock_length;
+        texts_.date_length = date_length;
+        texts_.generation++;
+        return true;
+    }
+
+    android::base::unique_fd fd_;
+    // Start of the minute the texts were formatted for.
+    time_t minute_start_ = 0;
+    Texts texts_ = {};
+};
+
+#endif  // HEALTHD_DRAW_CLOCK_H
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_ELEMENTS_H
+#define HEALTHD_DRAW_ELEMENTS_H
+
+#include <minui/minui.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "animation.h"
+#include "healthd_draw_backend.h"
+
+// One text of the battery screen, as described by a line of the screen
+// description, res/values/charger/elements.txt (product/etc/ first), which
+// lives next to animation.txt rather than in it so that the charger's
+// animation parser never sees lines it does not know. Lines not starting with
+// "element:" are ignored; an invalid one discards the whole list:
+//
+//   element: kind=text font=percent x=percent y=20 lines=1 color=0,179,13,255 text=DevTITANS
+//
+//   kind   text, percent, clock, date or charge; all but text are filled in each
+//          frame, charge with the charge rate and time to full once estimated.
+//   font   percent, clock or system: the font of that text field, or sys_font.
+//   x, y   center, a pixel value (negative ones measure from the right or bottom
+//          edge), or percent/clock to take that text field's pos_x/pos_y.
+//   dx, dy pixels added once positioned, and lines, that many lines of the font.
+//   color  r,g,b[,a], gradient for the percent ramp at the current level with
+//          the percent field's alpha, or clock for the clock field's color.
+//   text   the rest of the line, for kind=text.
+struct ScreenElement {
+    enum Kind : uint8_t { TEXT, PERCENT, CLOCK, DATE, CHARGE };
+    enum Font : uint8_t { FONT_PERCENT, FONT_CLOCK, FONT_SYSTEM };
+    // Where x or y comes from.
+    enum Anchor : uint8_t { ANCHOR_VALUE, ANCHOR_PERCENT, ANCHOR_CLOCK };
+    enum ColorSource : uint8_t { COLOR_FIXED, COLOR_GRADIENT, COLOR_CLOCK };
+    static constexpr size_t kMaxText = 32;
+
+    Kind kind = TEXT;
+    Font font = FONT_PERCENT;
+    Anchor x_anchor = ANCHOR_VALUE;
+    Anchor y_anchor = ANCHOR_VALUE;
+    // Pixels or CENTER_VAL, for ANCHOR_VALUE.
+    int x = CENTER_VAL;
+    int y = CENTER_VAL;
+    int dx = 0;
+    int dy = 0;
+    int lines = 0;
+    ColorSource color_source = COLOR_FIXED;
+    uint8_t r = 255, g = 255, b = 255, a = 255;
+    char text[kMaxText] = {};
+};
+
+// The screen when there is no screen description, or it has no element lines.
+static constexpr const char* kDefaultScreenElements[] = {
+        // Cabeçalho no topo, VERDE ESMERALDA: 20px de margem + altura da fonte.
+        "kind=text font=percent x=percent y=20 lines=1 color=0,179,13,255 text=DevTITANS",
+        // Subcabeçalho em VERMELHO RUBY: 20 (margem) + cabeçalho + 10 (espaço) + fonte.
+        "kind=text font=percent x=percent y=30 lines=2 color=185,30,60,255 text=$ 2025/1 @",
+        // Rodapé em AZUL SAFIRA: o valor NEGATIVO alinha embaixo, 20px acima da borda.
+        "kind=text font=percent x=percent y=-20 lines=-1 color=20,90,200,255 text=v2.7.3-final",
+        // Porcentagem no centro, com a cor do gradiente.
+        "kind=percent font=percent x=percent y=percent color=gradient",
+        // Taxa de carga e tempo até a carga completa, em CINZA PRATA, logo acima do
+        // rodapé; só aparece depois de alguns minutos carregando.
+        "kind=charge font=percent x=percent y=-20 lines=-2 color=192,192,192,255",
+};
+
+static inline bool parse_element_int(const std::string& value, int* out) {
+    char* end;
+    long parsed = strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || parsed < -100000 || parsed > 100000) return false;
+    *out = static_cast<int>(parsed);
+    return true;
+}
+
+static inline bool parse_element_position(const std::string& value, ScreenElement::Anchor* anchor,
+                                          int* pos) {
+    *anchor = ScreenElement::ANCHOR_VALUE;
+    if (value == "center") {
+        *pos = CENTER_VAL;
+    } else if (value == "percent") {
+        *anchor = ScreenElement::ANCHOR_PERCENT;
+    } else if (value == "clock") {
+        *anchor = ScreenElement::ANCHOR_CLOCK;
+    } else {
+        return parse_element_int(value, pos);
+    }
+    return true;
+}
+
+// Parses the part of an element line after "element:". Returns false on any
+// unknown key or malformed value.
+static inline bool parse_screen_element(const char* spec, ScreenElement* element) {
+    *element = {};
+    std::string rest = spec;
+    size_t text_pos = rest.find("text=");
+    if (text_pos != std::string::npos) {
+        std::string text = rest.substr(text_pos + 5);
+        if (text.empty() || text.size() >= ScreenElement::kMaxText) return false;
+        snprintf(element->text, sizeof(element->text), "%s", text.c_str());
+        rest.resize(text_pos);
+    }
+
+    size_t start = 0;
+    while (start < rest.size()) {
+        size_t end = rest.find(' ', start);
+        if (end == std::string::npos) end = rest.size();
+        std::string token = rest.substr(start, end - start);
+        start = end + 1;
+        if (token.empty()) continue;
+        size_t eq = token.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+
+        if (key == "kind") {
+            if (value == "text") {
+                element->kind = ScreenElement::TEXT;
+            } else if (value == "percent") {
+                element->kind = ScreenElement::PERCENT;
+            } else if (value == "clock") {
+                element->kind = ScreenElement::CLOCK;
+            } else if (value == "date") {
+                element->kind = ScreenElement::DATE;
+            } else if (value == "charge") {
+                element->kind = ScreenElement::CHARGE;
+            } else {
+                return false;
+            }
+        } else if (key == "font") {
+            if (value == "percent") {
+                element->font = ScreenElement::FONT_PERCENT;
+            } else if (value == "clock") {
+                element->font = ScreenElement::FONT_CLOCK;
+            } else if (value == "system") {
+                element->font = ScreenElement::FONT_SYSTEM;
+            } else {
+                return false;
+            }
+        } else if (key == "x") {
+            if (!parse_element_position(value, &element->x_anchor, &element->x)) return false;
+        } else if (key == "y") {
+            if (!parse_element_position(value, &element->y_anchor, &element->y)) return false;
+        } else if (key == "dx") {
+            if (!parse_element_int(value, &element->dx)) return false;
+        } else if (key == "dy") {
+            if (!parse_element_int(value, &element->dy)) return false;
+        } else if (key == "lines") {
+            if (!parse_element_int(value, &element->lines)) return false;
+        } else if (key == "color") {
+            if (value == "gradient") {
+                element->color_source = ScreenElement::COLOR_GRADIENT;
+            } else if (value == "clock") {
+                element->color_source = ScreenElement::COLOR_CLOCK;
+            } else {
+                int r, g, b, a = 255, n;
+                int fields = sscanf(value.c_str(), "%d,%d,%d%n,%d%n", &r, &g, &b, &n, &a, &n);
+                if ((fields != 3 && fields != 4) || static_cast<size_t>(n) != value.size() ||
+                    r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255 || a < 0 ||
+                    a > 255) {
+                    return false;
+                }
+                element->color_source = ScreenElement::COLOR_FIXED;
+                element->r = r;
+                element->g = g;
+                element->b = b;
+                element->a = a;
+            }
+        } else {
+            return false;
+        }
+    }
+    return element->kind != ScreenElement::TEXT || element->text[0] != '\0';
+}
+
+// Screen elements compiled against one layout, as a struct of arrays with one
+// index per element. Constant texts come first, then the texts filled in each
+// frame; each group is sorted by font and then color, so consecutive texts
+// rarely change drawing state.
+struct DrawList {
+    // Positions kept per element: the percent text has one per digit count
+    // ("0%".."9%", "10%".."99%", "100%"), the others just the first.
+    static constexpr int kVariants = 3;
+
+    size_t size() const { return kind.size(); }
+    void clear() {
+        kind.clear();
+        font.clear();
+        color_source.clear();
+        color.clear();
+        text.clear();
+        rect.clear();
+        static_count = 0;
+    }
+
+    std::vector<ScreenElement::Kind> kind;
+    std::vector<const GRFont*> font;
+    std::vector<ScreenElement::ColorSource> color_source;
+    // RGBA of COLOR_FIXED elements.
+    std::vector<uint32_t> color;
+    // Constant text of TEXT elements, nullptr for the others.
+    std::vector<const char*> text;
+    // Final rectangles, kVariants per element.
+    std::vector<DrawRect> rect;
+    // Elements [0, static_count) are constant texts.
+    size_t static_count = 0;
+};
+
+// "0%" to "100%", formatted once, so drawing the percent formats nothing.
+struct PercentTexts {
+    PercentTexts() {
+        for (int level = 0; level <= 100; level++) {
+            length[level] = snprintf(text[level], sizeof(text[level]), "%d%%", level);
+        }
+    }
+
+    char text[101][5];
+    int length[101];
+};
+
+static inline uint32_t pack_element_color(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    return static_cast<uint32_t>(r) << 24 | g << 16 | b << 8 | a;
+}
+
+#endif  // HEALTHD_DRAW_ELEMENTS_H
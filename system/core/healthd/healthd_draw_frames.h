@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_FRAMES_H
+#define HEALTHD_DRAW_FRAMES_H
+
+#include <minui/minui.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "healthd_draw_raster.h"
+
+// Battery animation frames kept run-length encoded, and decoded on demand into
+// a small LRU of surfaces. The encoded frames and the decoded ones together are
+// bounded by a byte budget, and fit_budget() gives up prefetching, then all but
+// one frame, rather than exceed it. Charger frames are mostly flat color, so
+// they compress well, and only the frame on screen and the next one need to be
+// decoded at any time.
+class AnimationFrameStore {
+  public:
+    // Frames decoded when the budget allows: the one on screen, and the next one
+    // being prefetched.
+    static constexpr size_t kMinDecodedFrames = 2;
+
+    // How fit_budget() kept the store within its budget.
+    enum Fallback : uint8_t {
+        // kMinDecodedFrames or more decoded frames fit next to the encoded ones.
+        FALLBACK_NONE,
+        // Only one does: nothing is prefetched, and each frame is decoded over
+        // the previous one when it is shown.
+        FALLBACK_NO_PREFETCH,
+        // Not even that: only the last frame, the one a full battery rests on,
+        // is kept, decoded, and shown in place of every frame.
+        FALLBACK_STATIC_FRAME,
+        // Not even one decoded frame fits: no frame is shown.
+        FALLBACK_NO_FRAMES,
+    };
+
+    struct Stats {
+        size_t frames;
+        size_t encoded_bytes;
+        size_t decoded_bytes;
+        // Largest encoded + decoded total held between calls.
+        size_t peak_resident_bytes;
+        size_t budget_bytes;
+        // Size of the largest frame, decoded.
+        size_t frame_bytes;
+        // Decoded frames the budget allows once the encoded frames are held.
+        size_t cache_capacity;
+        Fallback fallback;
+        int64_t hits;
+        int64_t misses;
+        int64_t prefetches;
+    };
+
+    explicit AnimationFrameStore(size_t budget_bytes) { stats_.budget_bytes = budget_bytes; }
+
+    // Decodes frames to dithered RGB565 instead, from 32-bit pixels packed for
+    // |source_format|, halving the decoded size. Must be called before add().
+    void set_rgb565(PixelFormat source_format) {
+        rgb565_ = true;
+        source_format_ = source_format;
+    }
+
+    // Whether add() takes |surface|: only 32-bit surfaces are encoded.
+    static bool can_encode(const GRSurface* surface) {
+        return surface != nullptr && surface->pixel_bytes == sizeof(uint32_t);
+    }
+
+    // Encodes |surface| as the next frame. Returns false, storing nothing, for
+    // surfaces can_encode() refuses.
+    bool add(const GRSurface* surface) {
+        if (!can_encode(surface)) return false;
+        EncodedFrame frame;
+        frame.width = surface->width;
+        frame.height = surface->height;
+        encode(surface, &frame.data);
+        frame.data.shrink_to_fit();
+        // Once the frames held leave no room to decode one, fit_budget() can
+        // only keep the last frame: drop the others now rather than hold them
+        // all over the budget.
+        size_t frame_bytes = std::max(max_frame_bytes_,
+                                      frame.width * frame.height * pixel_bytes());
+        if (stats_.encoded_bytes + frame.data.size() + frame_bytes > stats_.budget_bytes) {
+            frames_.clear();
+            stats_.encoded_bytes = 0;
+            static_only_ = true;
+        }
+        stats_.encoded_bytes += frame.data.size();
+        frames_.push_back(std::move(frame));
+        stats_.frames++;
+        max_frame_bytes_ = std::max(max_frame_bytes_, frame_bytes);
+        stats_.frame_bytes = max_frame_bytes_;
+        update_peak();
+        return true;
+    }
+
+    // Once every frame is added, sizes the cache of decoded frames to what the
+    // budget leaves, falling back as Fallback describes when that is less than
+    // kMinDecodedFrames. The encoded and decoded frames then never exceed the
+    // budget together.
+    Fallback fit_budget() {
+        size_t available = stats_.budget_bytes > stats_.encoded_bytes
+                                   ? stats_.budget_bytes - stats_.encoded_bytes
+                                   : 0;
+        size_t capacity = max_frame_bytes_ > 0 ? available / max_frame_bytes_ : 0;
+        if (static_only_) capacity = 0;
+        if (frames_.empty() || capacity >= kMinDecodedFrames) {
+            stats_.fallback = FALLBACK_NONE;
+            stats_.cache_capacity = std::max(kMinDecodedFrames, capacity);
+        } else if (capacity == 1) {
+            stats_.fallback = FALLBACK_NO_PREFETCH;
+            stats_.cache_capacity = 1;
+        } else {
+            // Keep the last frame alone, decoded. Its encoded copy only goes once
+            // it is decoded, so both must fit.
+            EncodedFrame last = std::move(frames_.back());
+            frames_.clear();
+            frames_.shrink_to_fit();
+            stats_.encoded_bytes = last.data.size();
+            stats_.fallback = FALLBACK_NO_FRAMES;
+            stats_.cache_capacity = 0;
+            if (last.width * last.height * pixel_bytes() + last.data.size() <=
+                stats_.budget_bytes) {
+                std::unique_ptr<GRSurface> surface = GRSurface::Create(
+                        last.width, last.height, last.width * pixel_bytes(), pixel_bytes());
+                if (surface && decode(last, surface.get())) {
+                    stats_.decoded_bytes = surface->row_bytes * surface->height;
+                    update_peak();
+                    slots_.push_back({static_cast<int>(stats_.frames) - 1, 0, std::move(surface)});
+                    stats_.fallback = FALLBACK_STATIC_FRAME;
+                    stats_.cache_capacity = 1;
+                }
+            }
+            stats_.encoded_bytes = 0;
+        }
+        return stats_.fallback;
+    }
+
+    void clear() {
+        frames_.clear();
+        slots_.clear();
+        size_t budget = stats_.budget_bytes;
+        stats_ = {};
+        stats_.budget_bytes = budget;
+        max_frame_bytes_ = 0;
+        static_only_ = false;
+        last_returned_ = -1;
+    }
+
+    // Frames added, whether or not fit_budget() kept them.
+    size_t size() const { return stats_.frames; }
+    const Stats& stats() const { return stats_; }
+
+    // Decoded frame |index|, or nullptr if out of range, decoding failed or the
+    // store keeps no frame. Only valid once fit_budget() was called. The surface
+    // may be decoded over by any later get() or prefetch() of another frame, so
+    // shown() tells which frame it holds.
+    GRSurface* get(int index) {
+        if (index < 0 || static_cast<size_t>(index) >= stats_.frames) return nullptr;
+        if (stats_.fallback == FALLBACK_STATIC_FRAME) {
+            last_returned_ = slots_[0].index;
+            return slots_[0].surface.get();
+        }
+        Slot* slot = find_or_decode(index);
+        if (slot == nullptr) return nullptr;
+        last_returned_ = index;
+        return slot->surface.get();
+    }
+
+    // Frame the surface last returned by get() holds: the one asked for, or the
+    // static frame in its place.
+    int shown() const { return last_returned_; }
+
+    // Decodes frame |index| ahead of time, so a later get() of it is a hit. Does
+    // nothing unless the budget leaves room for it.
+    void prefetch(int index) {
+        if (stats_.fallback != FALLBACK_NONE) return;
+        if (index < 0 || static_cast<size_t>(index) >= frames_.size()) return;
+        for (const Slot& slot : slots_) {
+            if (slot.index == index) return;
+        }
+        if (find_or_decode(index, false /* count */) != nullptr) stats_.prefetches++;
+    }
+
+  private:
+    struct EncodedFrame {
+        size_t width;
+        size_t height;
+        // Runs of 16-bit headers, each followed by its pixels: kRepeat | n means
+        // the next pixel is repeated n times, otherwise n literal pixels follow.
+        std::vector<uint8_t> data;
+    };
+    struct Slot {
+        int index;
+        uint64_t last_use;
+        std::unique_ptr<GRSurface> surface;
+    };
+
+    static constexpr uint16_t kRepeat = 0x8000;
+    static constexpr size_t kMaxRun = 0x7fff;
+    // Shorter repeats are cheaper kept as literals.
+    static constexpr size_t kMinRepeat = 3;
+
+    static uint32_t source_pixel(const GRSurface* surface, size_t i) {
+        uint32_t pixel;
+        memcpy(&pixel,
+               surface->data() + (i / surface->width) * surface->row_bytes +
+                       (i % surface->width) * sizeof(uint32_t),
+               sizeof(pixel));
+        return pixel;
+    }
+
+    static void put(std::vector<uint8_t>* out, const void* value, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        out->insert(out->end(), bytes, bytes + size);
+    }
+
+    static size_t repeat_length(const GRSurface* surface, size_t i, size_t count) {
+        uint32_t pixel = source_pixel(surface, i);
+        size_t run = 1;
+        while (i + run < count && run < kMaxRun && source_pixel(surface, i + run) == pixel) run++;
+        return run;
+    }
+
+    static void encode(const GRSurface* surface, std::vector<uint8_t>* out) {
+        const size_t count = surface->width * surface->height;
+        size_t i = 0;
+        while (i < count) {
+            size_t run = repeat_length(surface, i, count);
+            if (run >= kMinRepeat) {
+                uint16_t header = kRepeat | run;
+                uint32_t pixel = source_pixel(surface, i);
+                put(out, &header, sizeof(header));
+                put(out, &pixel, sizeof(pixel));
+                i += run;
+                continue;
+            }
+            size_t start = i;
+            while (i < count && i - start < kMaxRun &&
+                   repeat_length(surface, i, count) < kMinRepeat) {
+                i++;
+            }
+            uint16_t header = i - start;
+            put(out, &header, sizeof(header));
+            for (size_t j = start; j < i; j++) {
+                uint32_t pixel = source_pixel(surface, j);
+                put(out, &pixel, sizeof(pixel));
+            }
+        }
+    }
+
+    size_t pixel_bytes() const { return rgb565_ ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+    // Writes |run| pixels starting at pixel |i| of |surface|: |pixels| repeated
+    // if |repeat|, else that many of them.
+    void store(GRSurface* surface, size_t i, const uint8_t* pixels, size_t run,
+               bool repeat) const {
+        if (!rgb565_) {
+            uint32_t* dst = reinterpret_cast<uint32_t*>(surface->data()) + i;
+            if (repeat) {
+                uint32_t pixel;
+                memcpy(&pixel, pixels, sizeof(pixel));
+                std::fill(dst, dst + run, pixel);
+            } else {
+                memcpy(dst, pixels, run * sizeof(uint32_t));
+            }
+            return;
+        }
+        uint16_t* dst = reinterpret_cast<uint16_t*>(surface->data()) + i;
+        for (size_t k = 0; k < run; k++) {
+            uint32_t pixel, r, g, b;
+            memcpy(&pixel, pixels + (repeat ? 0 : k * sizeof(pixel)), sizeof(pixel));
+            raster_unpack(source_format_, pixel, &r, &g, &b);
+            int x = (i + k) % surface->width;
+            int y = (i + k) / surface->width;
+            dst[k] = raster_to_565(r, g, b, raster_threshold_565(true /* dither */, x, y));
+        }
+    }
+
+    bool decode(const EncodedFrame& frame, GRSurface* surface) const {
+        const size_t count = frame.width * frame.height;
+        size_t i = 0;
+        const uint8_t* src = frame.data.data();
+        const uint8_t* src_end = src + frame.data.size();
+        while (src + sizeof(uint16_t) <= src_end) {
+            uint16_t header;
+            memcpy(&header, src, sizeof(header));
+            src += sizeof(header);
+            size_t run = header & kMaxRun;
+            if (count - i < run) return false;
+            bool repeat = header & kRepeat;
+            size_t bytes = (repeat ? 1 : run) * sizeof(uint32_t);
+            if (src + bytes > src_end) return false;
+            store(surface, i, src, run, repeat);
+            src += bytes;
+            i += run;
+        }
+        return i == count;
+    }
+
+    Slot* find_or_decode(int index, bool count = true) {
+        if (index < 0 || static_cast<size_t>(index) >= frames_.size()) return nullptr;
+        use_clock_++;
+        for (Slot& slot : slots_) {
+            if (slot.index != index) continue;
+            slot.last_use = use_clock_;
+            if (count) stats_.hits++;
+            return &slot;
+        }
+        if (count) stats_.misses++;
+
+        // Reuse the least recently used slot, never the frame on screen unless
+        // it is the only one.
+        Slot* slot = nullptr;
+        if (slots_.size() < stats_.cache_capacity) {
+            slots_.push_back({-1, 0, nullptr});
+            slot = &slots_.back();
+        } else {
+            for (Slot& candidate : slots_) {
+                if (candidate.index == last_returned_ && slots_.size() > 1) continue;
+                if (slot == nullptr || candidate.last_use < slot->last_use) slot = &candidate;
+            }
+        }
+        if (slot == nullptr) return nullptr;
+        const EncodedFrame& frame = frames_[index];
+        if (!slot->surface || slot->surface->width != frame.width ||
+            slot->surface->height != frame.height) {
+            if (slot->surface) {
+                stats_.decoded_bytes -= slot->surface->row_bytes * slot->surface->height;
+            }
+            slot->surface = GRSurface::Create(frame.width, frame.height,
+                                              frame.width * pixel_bytes(), pixel_bytes());
+            if (!slot->surface) {
+                slot->index = -1;
+                return nullptr;
+            }
+            stats_.decoded_bytes += slot->surface->row_bytes * slot->surface->height;
+            update_peak();
+        }
+        if (!decode(frame, slot->surface.get())) {
+            slot->index = -1;
+            return nullptr;
+        }
+        slot->index = index;
+        slot->last_use = use_clock_;
+        return slot;
+    }
+
+    void update_peak() {
+        stats_.peak_resident_bytes =
+                std::max(stats_.peak_resident_bytes, stats_.encoded_bytes + stats_.decoded_bytes);
+    }
+
+    std::vector<EncodedFrame> frames_;
+    std::vector<Slot> slots_;
+    bool rgb565_ = false;
+    PixelFormat source_format_ = PixelFormat::UNKNOWN;
+    size_t max_frame_bytes_ = 0;
+    uint64_t use_clock_ = 0;
+    // Frame last handed out by get(), which must stay decoded while on screen.
+    int last_returned_ = -1;
+    // add() dropped all but the last frame; see fit_budget().
+    bool static_only_ = false;
+    Stats stats_ = {};
+};
+
+#endif  // HEALTHD_DRAW_FRAMES_H
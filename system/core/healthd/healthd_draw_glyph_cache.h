@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_GLYPH_CACHE_H
+#define HEALTHD_DRAW_GLYPH_CACHE_H
+
+#include <android-base/unique_fd.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+// On-disk format of precompiled glyph caches: a font's alpha texture stored raw
+// behind a small header, so the charger can map it and use it in place instead
+// of decoding the font PNG. Caches are built from the PNGs at image build time
+// by healthd_glyph_cache and installed in kGlyphCacheDir; nothing writes them
+// on the device.
+//
+// The header records the size of the PNG the cache was built from and a digest
+// of the CRC-32 every PNG chunk ends with, not its mtime, which image builds do
+// not preserve. The CRCs cover the chunks' contents, so a cache is only used
+// for the PNG it was built from, yet checking one reads a few bytes per chunk
+// rather than the whole PNG.
+//
+// Layout, native-endian: GlyphCacheHeader, then height * row_bytes texture
+// bytes starting at offset sizeof(GlyphCacheHeader).
+struct GlyphCacheHeader {
+    static constexpr uint32_t kMagic = 0x43474448;  // "HDGC"
+    static constexpr uint32_t kVersion = 3;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t char_width;
+    uint32_t char_height;
+    uint32_t width;
+    uint32_t height;
+    uint32_t row_bytes;
+    uint32_t reserved;
+    int64_t source_size;
+    uint64_t source_digest;
+};
+static_assert(sizeof(GlyphCacheHeader) % 8 == 0, "texture must stay 8-byte aligned");
+
+static constexpr const char* kGlyphCacheDir = "/res/images/glyph_cache";
+
+// Where minui's gr_init_font() reads font |name| from: absolute names as they
+// are, others from /res/images.
+static inline std::string font_png_path(const std::string& name) {
+    if (!name.empty() && name[0] == '/') return name;
+    return "/res/images/" + name + ".png";
+}
+
+// The cache of font |name| in |dir|, named after the font with any '/'
+// replaced, e.g. "percent.glyphs" or "_vendor_res_percent.png.glyphs".
+static inline std::string glyph_cache_path(const std::string& dir, const std::string& name) {
+    std::string file = name;
+    std::replace(file.begin(), file.end(), '/', '_');
+    return dir + "/" + file + ".glyphs";
+}
+
+// Identifies the PNG a cache was built from.
+struct GlyphCacheSource {
+    int64_t size;
+    // 64-bit FNV-1a of the CRC-32 of every chunk, in file order.
+    uint64_t digest;
+};
+
+// Reads the chunk CRCs of the PNG at |path| into |source|: the signature, then
+// for each chunk its length and type, followed by its CRC. Returns false if it
+// cannot be read or is not a PNG ending in IEND.
+static inline bool read_glyph_cache_source(const std::string& path, GlyphCacheSource* source) {
+    static constexpr uint8_t kPngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    android::base::unique_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0) return false;
+    struct stat st;
+    if (fstat(fd.get(), &st) < 0) return false;
+
+    // Each read takes a chunk's CRC along with the length and type of the next
+    // one; the first takes the signature and the first chunk's length and type.
+    uint8_t bytes[16];
+    if (TEMP_FAILURE_RETRY(pread(fd.get(), bytes, 16, 0)) != 16 ||
+        memcmp(bytes, kPngSignature, sizeof(kPngSignature)) != 0) {
+        return false;
+    }
+    const uint8_t* chunk = bytes + 8;
+    uint64_t digest = 0xcbf29ce484222325ULL;
+    int64_t offset = 8;
+    while (true) {
+        uint32_t length = static_cast<uint32_t>(chunk[0]) << 24 | chunk[1] << 16 |
+                          chunk[2] << 8 | chunk[3];
+        bool last = memcmp(chunk + 4, "IEND", 4) == 0;
+        offset += 8 + static_cast<int64_t>(length);
+        ssize_t count = last ? 4 : 12;
+        if (offset + count > st.st_size ||
+            TEMP_FAILURE_RETRY(pread(fd.get(), bytes, count, offset)) != count) {
+            return false;
+        }
+        for (int i = 0; i < 4; i++) digest = (digest ^ bytes[i]) * 0x100000001b3ULL;
+        offset += 4;
+        if (last) break;
+        chunk = bytes + 4;
+    }
+    *source = {static_cast<int64_t>(st.st_size), digest};
+    return true;
+}
+
+// Writes a cache of the |width| x |height| alpha texture at |pixels|, holding
+// glyphs of |char_width| x |char_height|, at |path|, through a temporary file
+// so readers never see a partial one.
+static inline bool write_glyph_cache(const std::string& path, const GlyphCacheSource& source,
+                                     uint32_t char_width, uint32_t char_height, uint32_t width,
+                                     uint32_t height, uint32_t row_bytes, const uint8_t* pixels) {
+    GlyphCacheHeader header = {};
+    header.magic = GlyphCacheHeader::kMagic;
+    header.version = GlyphCacheHeader::kVersion;
+    header.char_width = char_width;
+    header.char_height = char_height;
+    header.width = width;
+    header.height = height;
+    header.row_bytes = row_bytes;
+    header.source_size = source.size;
+    header.source_digest = source.digest;
+
+    std::string temp = path + ".tmp";
+    FILE* file = fopen(temp.c_str(), "we");
+    if (file == nullptr) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t y = 0; ok && y < height; y++) {
+        ok = fwrite(pixels + y * row_bytes, row_bytes, 1, file) == 1;
+    }
+    ok &= fclose(file) == 0;
+    if (ok) ok = rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok) unlink(temp.c_str());
+    return ok;
+}
+
+#endif  // HEALTHD_DRAW_GLYPH_CACHE_H
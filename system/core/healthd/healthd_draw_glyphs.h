@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_GLYPHS_H
+#define HEALTHD_DRAW_GLYPHS_H
+
+#include <android-base/unique_fd.h>
+#include <fcntl.h>
+#include <minui/minui.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "healthd_draw_glyph_cache.h"
+
+// A font whose texture points into a mapped glyph cache.
+class MappedGlyphFont {
+  public:
+    // Maps the cache at |path|. Returns nullptr if it is missing or malformed, or
+    // if it was not built from |source|.
+    static std::unique_ptr<MappedGlyphFont> Map(const std::string& path,
+                                                const GlyphCacheSource& source) {
+        android::base::unique_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+        if (fd.get() < 0) return nullptr;
+        struct stat st;
+        if (fstat(fd.get(), &st) < 0 || st.st_size < static_cast<off_t>(sizeof(GlyphCacheHeader))) {
+            return nullptr;
+        }
+        size_t size = st.st_size;
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+        if (map == MAP_FAILED) return nullptr;
+        std::unique_ptr<MappedGlyphFont> font(new MappedGlyphFont(static_cast<uint8_t*>(map), size));
+
+        const GlyphCacheHeader& header = *static_cast<const GlyphCacheHeader*>(map);
+        if (header.magic != GlyphCacheHeader::kMagic ||
+            header.version != GlyphCacheHeader::kVersion || header.row_bytes < header.width ||
+            header.char_width == 0 || header.char_height == 0 ||
+            header.width < 95 * header.char_width || header.height < header.char_height ||
+            size != sizeof(header) + static_cast<size_t>(header.height) * header.row_bytes) {
+            return nullptr;
+        }
+        if (header.source_size != source.size || header.source_digest != source.digest) {
+            return nullptr;
+        }
+        font->texture_.reset(new Texture(header, font->map_ + sizeof(header)));
+        font->font_.texture = font->texture_.get();
+        font->font_.char_width = header.char_width;
+        font->font_.char_height = header.char_height;
+        return font;
+    }
+
+    ~MappedGlyphFont() { munmap(map_, size_); }
+
+    const GRFont* font() const { return &font_; }
+
+  private:
+    // Texture surface reading the mapped bytes in place.
+    class Texture : public GRSurface {
+      public:
+        Texture(const GlyphCacheHeader& header, uint8_t* data)
+            : GRSurface(header.width, header.height, header.row_bytes, 1), data_(data) {}
+        uint8_t* data() override { return data_; }
+
+      private:
+        uint8_t* data_;
+    };
+
+    MappedGlyphFont(uint8_t* map, size_t size) : map_(map), size_(size) {}
+
+    uint8_t* map_;
+    size_t size_;
+    std::unique_ptr<Texture> texture_;
+    GRFont font_ = {};
+};
+
+#endif  // HEALTHD_DRAW_GLYPHS_H
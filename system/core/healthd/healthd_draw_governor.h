@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_GOVERNOR_H
+#define HEALTHD_DRAW_GOVERNOR_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <climits>
+
+// Decides how often the charger screen is redrawn. Visible changes (level,
+// status, the minute, unblanking) are always drawn at once and keep the screen
+// at full rate for a while, as does a running animation. Once steady, redraws
+// slow down; a steady screen slows down further while the battery is hot,
+// nearly empty or full, and redraws stop while every connector is blanked.
+class FrameGovernor {
+  public:
+    enum Mode : uint8_t { MODE_ACTIVE, MODE_STEADY, MODE_THROTTLED, MODE_STOPPED, MODE_COUNT };
+    // Why the governor throttles.
+    enum Reason : uint8_t { REASON_NONE, REASON_TEMPERATURE, REASON_LOW_LEVEL, REASON_FULL };
+
+    struct Config {
+        // Shortest time between frames in each mode; MODE_STOPPED draws nothing.
+        int active_interval_ms = 33;
+        int steady_interval_ms = 5000;
+        int throttled_interval_ms = 30000;
+        // How long the screen stays at full rate after a visible change.
+        int settle_ms = 2000;
+        // Throttle at or above this battery temperature, in tenths of a degree
+        // Celsius, and at or below this level.
+        int throttle_temperature = 450;
+        int throttle_level = 5;
+    };
+
+    // What the frame about to be drawn shows.
+    struct Inputs {
+        bool blanked;
+        // A multi-frame animation is running.
+        bool animating;
+        int level;
+        int status;
+        bool full;
+        // Changes once a minute, with the clock.
+        uint64_t minute;
+        // Tenths of a degree Celsius, or INT_MIN if unknown.
+        int temperature;
+    };
+
+    struct Stats {
+        Mode mode;
+        Reason reason;
+        int interval_ms;
+        // Frames drawn and refused, and how many of the drawn ones were visible
+        // changes.
+        int64_t admitted;
+        int64_t refused;
+        int64_t transitions;
+        // Mode changes, and time spent in each mode.
+        int64_t mode_changes;
+        int64_t mode_ms[MODE_COUNT];
+        // Frames drawn in the last minute.
+        int frames_per_minute;
+    };
+
+    FrameGovernor() : FrameGovernor(Config()) {}
+    explicit FrameGovernor(const Config& config) : config_(config) {}
+
+    // Whether the frame described by |in| should be drawn at |now_ms|.
+    bool admit(const Inputs& in, int64_t now_ms) {
+        account(now_ms);
+        bool transition = force_ || !started_ || in.level != last_.level ||
+                          in.status != last_.status || in.full != last_.full ||
+                          in.minute != last_.minute || (last_.blanked && !in.blanked);
+        force_ = false;
+        started_ = true;
+        last_ = in;
+        if (transition) active_until_ms_ = now_ms + config_.settle_ms;
+
+        Mode mode = choose(in, now_ms);
+        if (mode != stats_.mode) stats_.mode_changes++;
+        stats_.mode = mode;
+        stats_.interval_ms = interval_ms(mode);
+
+        bool due = last_frame_ms_ == INT64_MIN || now_ms - last_frame_ms_ >= stats_.interval_ms;
+        if (mode == MODE_STOPPED || (!transition && !due)) {
+            stats_.refused++;
+            return false;
+        }
+        if (transition) stats_.transitions++;
+        stats_.admitted++;
+        last_frame_ms_ = now_ms;
+        count_frame(now_ms);
+        return true;
+    }
+
+    // Lets the next frame through as a visible change, e.g. after a rotation.
+    void force_next_frame() { force_ = true; }
+
+    // Milliseconds until a frame with no visible change would be drawn, for the
+    // caller's poll timeout; -1 if none will be while stopped.
+    int next_frame_ms(int64_t now_ms) const {
+        if (stats_.mode == MODE_STOPPED) return -1;
+        if (last_frame_ms_ == INT64_MIN) return 0;
+        int64_t due = last_frame_ms_ + stats_.interval_ms - now_ms;
+        return static_cast<int>(std::clamp<int64_t>(due, 0, INT_MAX));
+    }
+
+    Stats stats(int64_t now_ms) {
+        account(now_ms);
+        Stats stats = stats_;
+        stats.frames_per_minute = 0;
+        for (int i = 0; i < kMinuteSeconds; i++) {
+            if (now_ms / 1000 - second_[i] < kMinuteSeconds) stats.frames_per_minute += frames_[i];
+        }
+        return stats;
+    }
+
+  private:
+    static constexpr int kMinuteSeconds = 60;
+
+    // Throttling only stretches the steady interval: a running animation, or a
+    // screen settling after a visible change, stays at full rate whatever the
+    // level or temperature.
+    Mode choose(const Inputs& in, int64_t now_ms) {
+        stats_.reason = REASON_NONE;
+        if (in.blanked) return MODE_STOPPED;
+        if (in.animating || now_ms < active_until_ms_) return MODE_ACTIVE;
+        if (in.temperature != INT_MIN && in.temperature >= config_.throttle_temperature) {
+            stats_.reason = REASON_TEMPERATURE;
+        } else if (in.full) {
+            stats_.reason = REASON_FULL;
+        } else if (in.level >= 0 && in.level <= config_.throttle_level) {
+            stats_.reason = REASON_LOW_LEVEL;
+        }
+        return stats_.reason != REASON_NONE ? MODE_THROTTLED : MODE_STEADY;
+    }
+
+    int interval_ms(Mode mode) const {
+        switch (mode) {
+            case MODE_ACTIVE:
+                return config_.active_interval_ms;
+            case MODE_STEADY:
+                return config_.steady_interval_ms;
+            case MODE_THROTTLED:
+                return config_.throttled_interval_ms;
+            default:
+                return INT_MAX;
+        }
+    }
+
+    void account(int64_t now_ms) {
+        if (last_account_ms_ != INT64_MIN) stats_.mode_ms[stats_.mode] += now_ms - last_account_ms_;
+        last_account_ms_ = now_ms;
+    }
+
+    // Frames per second over the last minute, in a ring indexed by second.
+    void count_frame(int64_t now_ms) {
+        int64_t second = now_ms / 1000;
+        int slot = second % kMinuteSeconds;
+        if (second_[slot] != second) {
+            second_[slot] = second;
+            frames_[slot] = 0;
+        }
+        frames_[slot]++;
+    }
+
+    Config config_;
+    Stats stats_ = {};
+    Inputs last_ = {};
+    bool started_ = false;
+    bool force_ = false;
+    int64_t active_until_ms_ = INT64_MIN;
+    int64_t last_frame_ms_ = INT64_MIN;
+    int64_t last_account_ms_ = INT64_MIN;
+    int64_t second_[kMinuteSeconds] = {};
+    int frames_[kMinuteSeconds] = {};
+};
+
+#endif  // HEALTHD_DRAW_GOVERNOR_H
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_GRADIENT_H
+#define HEALTHD_DRAW_GRADIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Color of the percent text as a function of the battery level. The ramp is a
+// list of stops interpolated linearly, in float, exactly as draw_percent() used
+// to do each frame; it is baked into a 101-entry table, at compile time for
+// the default ramp and once at startup for a custom one, so picking the color
+// for a level is a single load.
+//
+// A device replaces kDefaultGradient with lines of the screen description,
+// res/values/charger/elements.txt (see healthd_draw_elements.h), one per stop:
+//
+//   percent_gradient: <level> <r> <g> <b>
+//
+// Levels must increase from 0 to 100; otherwise the default ramp is kept.
+
+struct GradientStop {
+    int level;
+    uint8_t r, g, b;
+};
+
+struct GradientColor {
+    uint8_t r, g, b, a;
+};
+
+struct GradientLut {
+    static constexpr int kLevels = 101;
+    GradientColor colors[kLevels];
+    // Levels actually covered by the ramp; entries outside are left black.
+    bool filled[kLevels];
+
+    const GradientColor& at(int level) const {
+        return colors[level < 0 ? 0 : level >= kLevels ? kLevels - 1 : level];
+    }
+};
+
+// Vermelho (0%) -> Laranja -> Amarelo (50%) -> Verde-Limão -> Verde (100%).
+static constexpr GradientStop kDefaultGradient[] = {
+        {0, 255, 0, 0},     // Vermelho (0%)
+        {15, 255, 69, 0},   // Laranja-Avermelhado (15%)
+        {30, 255, 140, 0},  // Laranja-Escuro (30%)
+        {45, 255, 165, 0},  // Laranja (45%)
+        {50, 255, 255, 0},  // Amarelo (50%)
+        {65, 178, 255, 0},  // Verde-Limão Amarelado (65%)
+        {75, 127, 255, 0},  // Verde-Limão (75%)
+        {85, 76, 255, 0},   // Verde-Claro (85%)
+        {100, 0, 255, 0}    // Verde (100%)
+};
+
+// The float interpolation draw_percent() did per frame, now only run when a
+// ramp is baked. An integer lerp matches it on the default ramp but is off by
+// one for some custom ones, where the float product lands just below a whole
+// number, so the table is not fixed point.
+static constexpr uint8_t gradient_lerp(int from, int to, int offset, int span) {
+    float t = float(offset) / float(span);
+    return static_cast<uint8_t>(from + (int)((to - from) * t));
+}
+
+// Bakes |count| stops, sorted by strictly increasing level, into a table. Each
+// level takes the first segment [stop i, stop i + 1] containing it.
+static constexpr GradientLut make_gradient_lut(const GradientStop* stops, size_t count) {
+    GradientLut lut = {};
+    for (int level = 0; level < GradientLut::kLevels; level++) {
+        for (size_t i = 0; i + 1 < count; i++) {
+            const GradientStop& lo = stops[i];
+            const GradientStop& hi = stops[i + 1];
+            if (level < lo.level || level > hi.level) continue;
+            int offset = level - lo.level;
+            int span = hi.level - lo.level;
+            lut.colors[level] = {gradient_lerp(lo.r, hi.r, offset, span),
+                                 gradient_lerp(lo.g, hi.g, offset, span),
+                                 gradient_lerp(lo.b, hi.b, offset, span), 255};
+            lut.filled[level] = true;
+            break;
+        }
+    }
+    return lut;
+}
+
+// True if the stops are usable: strictly increasing levels covering 0..100.
+static constexpr bool gradient_stops_valid(const GradientStop* stops, size_t count) {
+    if (count < 2 || stops[0].level != 0 || stops[count - 1].level != GradientLut::kLevels - 1) {
+        return false;
+    }
+    for (size_t i = 0; i + 1 < count; i++) {
+        if (stops[i].level >= stops[i + 1].level) return false;
+    }
+    return true;
+}
+
+static constexpr bool gradient_lut_complete(const GradientLut& lut) {
+    for (int level = 0; level < GradientLut::kLevels; level++) {
+        if (!lut.filled[level]) return false;
+    }
+    return true;
+}
+
+static constexpr size_t kDefaultGradientStops =
+        sizeof(kDefaultGradient) / sizeof(kDefaultGradient[0]);
+static constexpr GradientLut kDefaultGradientLut =
+        make_gradient_lut(kDefaultGradient, kDefaultGradientStops);
+
+static_assert(gradient_stops_valid(kDefaultGradient, kDefaultGradientStops),
+              "default gradient stops must be increasing and span 0..100");
+static_assert(gradient_lut_complete(kDefaultGradientLut),
+              "default gradient must cover every level from 0 to 100");
+
+#endif  // HEALTHD_DRAW_GRADIENT_H
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_KERNELS_H
+#define HEALTHD_DRAW_KERNELS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HEALTHD_KERNELS_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HEALTHD_KERNELS_NEON 1
+#endif
+
+// Span kernels behind the software rasterizer (healthd_draw_raster.h): blending
+// a row of glyph coverage over 32-bit pixels, and filling opaque spans. Each has
+// a scalar version and SSE2/AVX2 or NEON versions that produce the same bits;
+// raster_kernels() picks the widest one the CPU supports, once.
+//
+// Opaque blits stay on memcpy(), which libc already vectorizes for the CPU.
+
+// Same blend as minui's pixel_blend(): channel-wise lerp, alpha taken from |color|.
+static inline uint32_t raster_blend(uint8_t alpha, uint32_t color, uint32_t pix) {
+    if (alpha == 255) return color;
+    if (alpha == 0) return pix;
+    uint32_t out = 0;
+    for (int shift = 0; shift < 24; shift += 8) {
+        uint32_t p = (pix >> shift) & 0xff;
+        uint32_t c = (color >> shift) & 0xff;
+        out |= (((p * (255 - alpha) + c * alpha) / 255) & 0xff) << shift;
+    }
+    return out | (color & 0xff000000);
+}
+
+struct RasterKernels {
+    const char* name;
+    // Blends |color| over |count| pixels of |dst|, weighted by |mask| coverage
+    // scaled by the alpha of |color|, like gr_text() does for one glyph row.
+    void (*blend_mask)(uint32_t* dst, const uint8_t* mask, int count, uint32_t color);
+    // Sets |count| pixels of |dst| to |color|.
+    void (*fill)(uint32_t* dst, int count, uint32_t color);
+};
+
+static inline void raster_blend_mask_scalar(uint32_t* dst, const uint8_t* mask, int count,
+                                            uint32_t color) {
+    uint8_t alpha_current = color >> 24;
+    for (int i = 0; i < count; i++) {
+        uint8_t a = mask[i];
+        if (alpha_current < 255) a = (static_cast<uint32_t>(a) * alpha_current) / 255;
+        dst[i] = raster_blend(a, color, dst[i]);
+    }
+}
+
+static inline void raster_fill_scalar(uint32_t* dst, int count, uint32_t color) {
+    std::fill(dst, dst + count, color);
+}
+
+static constexpr RasterKernels kScalarRasterKernels = {"scalar", raster_blend_mask_scalar,
+                                                       raster_fill_scalar};
+
+// x / 255 for x in [0, 255 * 255], exact, on 16-bit lanes.
+#define HEALTHD_DIV255_EPI16(prefix, x) \
+    prefix##_srli_epi16(prefix##_add_epi16(prefix##_add_epi16(x, prefix##_set1_epi16(1)), \
+                                           prefix##_srli_epi16(x, 8)),                   \
+                        8)
+
+#if defined(HEALTHD_KERNELS_X86) && defined(__SSE2__)
+
+static inline void raster_blend_mask_sse2(uint32_t* dst, const uint8_t* mask, int count,
+                                          uint32_t color) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i color32 = _mm_set1_epi32(color);
+    const __m128i color16 = _mm_unpacklo_epi8(color32, zero);
+    const __m128i alpha_current = _mm_set1_epi16(color >> 24);
+    const __m128i channel_255 = _mm_set1_epi16(255);
+    const __m128i rgb_mask = _mm_set1_epi32(0x00ffffff);
+    const __m128i color_alpha = _mm_andnot_si128(rgb_mask, color32);
+    const bool modulate = (color >> 24) < 255;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32_t coverage;
+        memcpy(&coverage, mask + i, sizeof(coverage));
+        if (coverage == 0) continue;
+        __m128i a16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(coverage), zero);
+        if (modulate) {
+            __m128i scaled = _mm_mullo_epi16(a16, alpha_current);
+            a16 = HEALTHD_DIV255_EPI16(_mm, scaled);
+        }
+        __m128i a32 = _mm_unpacklo_epi16(a16, zero);
+        // Each pixel's alpha repeated on its four 16-bit channels.
+        __m128i aa = _mm_or_si128(a32, _mm_slli_epi32(a32, 16));
+        __m128i alpha_lo = _mm_unpacklo_epi32(aa, aa);
+        __m128i alpha_hi = _mm_unpackhi_epi32(aa, aa);
+
+        __m128i pix = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i pix_lo = _mm_unpacklo_epi8(pix, zero);
+        __m128i pix_hi = _mm_unpackhi_epi8(pix, zero);
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(pix_lo, _mm_sub_epi16(channel_255, alpha_lo)),
+                                   _mm_mullo_epi16(color16, alpha_lo));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(pix_hi, _mm_sub_epi16(channel_255, alpha_hi)),
+                                   _mm_mullo_epi16(color16, alpha_hi));
+        lo = HEALTHD_DIV255_EPI16(_mm, lo);
+        hi = HEALTHD_DIV255_EPI16(_mm, hi);
+        __m128i out = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), rgb_mask), color_alpha);
+        // Zero coverage leaves the pixel untouched, alpha included.
+        __m128i keep = _mm_cmpeq_epi32(a32, zero);
+        out = _mm_or_si128(_mm_and_si128(keep, pix), _mm_andnot_si128(keep, out));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+    raster_blend_mask_scalar(dst + i, mask + i, count - i, color);
+}
+
+static inline void raster_fill_sse2(uint32_t* dst, int count, uint32_t color) {
+    const __m128i value = _mm_set1_epi32(color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    raster_fill_scalar(dst + i, count - i, color);
+}
+
+static constexpr RasterKernels kSse2RasterKernels = {"sse2", raster_blend_mask_sse2,
+                                                     raster_fill_sse2};
+
+__attribute__((target("avx2"))) static inline void raster_blend_mask_avx2(uint32_t* dst,
+                                                                          const uint8_t* mask,
+                                                                          int count,
+                                                                          uint32_t color) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i color32 = _mm256_set1_epi32(color);
+    const __m256i color16 = _mm256_unpacklo_epi8(color32, zero);
+    const __m256i alpha_current = _mm256_set1_epi16(color >> 24);
+    const __m256i channel_255 = _mm256_set1_epi16(255);
+    const __m256i rgb_mask = _mm256_set1_epi32(0x00ffffff);
+    const __m256i color_alpha = _mm256_andnot_si256(rgb_mask, color32);
+    const bool modulate = (color >> 24) < 255;
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t coverage;
+        memcpy(&coverage, mask + i, sizeof(coverage));
+        if (coverage == 0) continue;
+        __m128i a16 = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask + i)));
+        if (modulate) {
+            __m128i scaled = _mm_mullo_epi16(a16, _mm256_castsi256_si128(alpha_current));
+            a16 = HEALTHD_DIV255_EPI16(_mm, scaled);
+        }
+        // In pixel order; the unpacks below work within 128-bit lanes, matching
+        // the pixel unpacks, and packus puts the pixels back in order.
+        __m256i a32 = _mm256_cvtepu16_epi32(a16);
+        __m256i aa = _mm256_or_si256(a32, _mm256_slli_epi32(a32, 16));
+        __m256i alpha_lo = _mm256_unpacklo_epi32(aa, aa);
+        __m256i alpha_hi = _mm256_unpackhi_epi32(aa, aa);
+
+        __m256i pix = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i pix_lo = _mm256_unpacklo_epi8(pix, zero);
+        __m256i pix_hi = _mm256_unpackhi_epi8(pix, zero);
+        __m256i lo = _mm256_add_epi16(
+                _mm256_mullo_epi16(pix_lo, _mm256_sub_epi16(channel_255, alpha_lo)),
+                _mm256_mullo_epi16(color16, alpha_lo));
+        __m256i hi = _mm256_add_epi16(
+                _mm256_mullo_epi16(pix_hi, _mm256_sub_epi16(channel_255, alpha_hi)),
+                _mm256_mullo_epi16(color16, alpha_hi));
+        lo = HEALTHD_DIV255_EPI16(_mm256, lo);
+        hi = HEALTHD_DIV255_EPI16(_mm256, hi);
+        __m256i out = _mm256_or_si256(_mm256_and_si256(_mm256_packus_epi16(lo, hi), rgb_mask),
+                                      color_alpha);
+        __m256i keep = _mm256_cmpeq_epi32(a32, zero);
+        out = _mm256_blendv_epi8(out, pix, keep);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+    raster_blend_mask_sse2(dst + i, mask + i, count - i, color);
+}
+
+__attribute__((target("avx2"))) static inline void raster_fill_avx2(uint32_t* dst, int count,
+                                                                    uint32_t color) {
+    const __m256i value = _mm256_set1_epi32(color);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), value);
+    }
+    raster_fill_sse2(dst + i, count - i, color);
+}
+
+static constexpr RasterKernels kAvx2RasterKernels = {"avx2", raster_blend_mask_avx2,
+                                                     raster_fill_avx2};
+
+#elif defined(HEALTHD_KERNELS_NEON)
+
+// x / 255 for x in [0, 255 * 255], exact, narrowed to bytes.
+static inline uint8x8_t raster_div255_neon(uint16x8_t x) {
+    return vshrn_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+static inline void raster_blend_mask_neon(uint32_t* dst, const uint8_t* mask, int count,
+                                          uint32_t color) {
+    uint8x8_t color_channel[3];
+    for (int c = 0; c < 3; c++) color_channel[c] = vdup_n_u8((color >> (8 * c)) & 0xff);
+    const uint8x8_t color_alpha = vdup_n_u8(color >> 24);
+    const bool modulate = (color >> 24) < 255;
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8_t a = vld1_u8(mask + i);
+        if (vget_lane_u64(vreinterpret_u64_u8(a), 0) == 0) continue;
+        if (modulate) a = raster_div255_neon(vmull_u8(a, color_alpha));
+        const uint8x8_t inv = vmvn_u8(a);  // 255 - a
+        const uint8x8_t keep = vceq_u8(a, vdup_n_u8(0));
+
+        uint8x8x4_t pix = vld4_u8(reinterpret_cast<const uint8_t*>(dst + i));
+        uint8x8x4_t out;
+        for (int c = 0; c < 3; c++) {
+            uint16x8_t sum = vmlal_u8(vmull_u8(pix.val[c], inv), color_channel[c], a);
+            out.val[c] = vbsl_u8(keep, pix.val[c], raster_div255_neon(sum));
+        }
+        out.val[3] = vbsl_u8(keep, pix.val[3], color_alpha);
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), out);
+    }
+    raster_blend_mask_scalar(dst + i, mask + i, count - i, color);
+}
+
+static inline void raster_fill_neon(uint32_t* dst, int count, uint32_t color) {
+    const uint32x4_t value = vdupq_n_u32(color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) vst1q_u32(dst + i, value);
+    raster_fill_scalar(dst + i, count - i, color);
+}
+
+static constexpr RasterKernels kNeonRasterKernels = {"neon", raster_blend_mask_neon,
+                                                     raster_fill_neon};
+
+#endif
+
+#undef HEALTHD_DIV255_EPI16
+
+// Widest kernel set this CPU runs, picked on first use.
+static inline const RasterKernels& raster_kernels() {
+#if defined(HEALTHD_KERNELS_X86) && defined(__SSE2__)
+    static const RasterKernels& kernels =
+            __builtin_cpu_supports("avx2") ? kAvx2RasterKernels : kSse2RasterKernels;
+    return kernels;
+#elif defined(HEALTHD_KERNELS_NEON)
+    return kNeonRasterKernels;
+#else
+    return kScalarRasterKernels;
+#endif
+}
+
+#endif  // HEALTHD_DRAW_KERNELS_H
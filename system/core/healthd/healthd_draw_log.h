@@ -0,0 +1,434 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_LOG_H
+#define HEALTHD_DRAW_LOG_H
+
+#include <cutils/klog.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+// Messages above this klog level are compiled out, arguments included. Build
+// with -DHEALTHD_DRAW_LOG_LEVEL=KLOG_DEBUG_LEVEL to keep the LOGV call sites.
+#ifndef HEALTHD_DRAW_LOG_LEVEL
+#define HEALTHD_DRAW_LOG_LEVEL KLOG_INFO_LEVEL
+#endif
+
+// Logs printf-style to kmsg from charger call sites, some of which run every
+// frame. A call site costs nothing unless its level is compiled in. When it is,
+// the call copies its arguments into a record, in a ring allocated once, and a
+// background thread formats and writes it. Each call site has its own budget:
+// a message the site just wrote is held back for kRepeatMs, and past kBurst
+// messages the site may write one per kRefillMs. What a site held back is
+// counted and reported with its next message.
+class ChargerLog {
+  public:
+    static constexpr int kRecords = 64;
+    static constexpr int kMaxArgs = 8;
+    // Bytes for the string arguments of one message; longer ones are cut.
+    static constexpr size_t kStringBytes = 96;
+    static constexpr size_t kLineLength = 256;
+    static constexpr int kBurst = 5;
+    static constexpr int64_t kRefillMs = 5000;
+    static constexpr int64_t kRepeatMs = 60 * 1000;
+
+    enum Mode : uint8_t {
+        // Nothing is logged.
+        MODE_OFF,
+        // Every message is formatted and written on the calling thread, with no
+        // budget, as plain KLOG does.
+        MODE_DIRECT,
+        MODE_DEFERRED,
+    };
+
+    // Receives each formatted line, at its klog level.
+    using Sink = void (*)(int level, const char* line, void* context);
+
+    // Budget of one call site. Zero-initialized, so a static Site needs no
+    // guard.
+    struct Site {
+        bool primed;
+        int tokens;
+        int64_t refill_ms;
+        uint64_t last_hash;
+        int64_t last_ms;
+        int suppressed;
+    };
+
+    struct Stats {
+        // Calls that reached the logger, lines written for them, calls held
+        // back by their site's budget, and calls lost to a full ring.
+        uint64_t logged;
+        uint64_t written;
+        uint64_t suppressed;
+        uint64_t dropped;
+    };
+
+    // Process-wide, and never destroyed, so call sites in static destructors
+    // and threads still running at exit stay safe.
+    static ChargerLog& get() {
+        static ChargerLog* log = new ChargerLog();
+        return *log;
+    }
+
+    // Only there for -Wformat: calls to it are never run.
+    __attribute__((format(printf, 1, 2))) static void check_format(const char*, ...) {}
+
+    template <typename... Args>
+    void log(int level, Site* site, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= kMaxArgs, "too many arguments for ChargerLog");
+        Mode mode = mode_.load(std::memory_order_relaxed);
+        if (mode == MODE_OFF) return;
+        Record record;
+        record.level = level;
+        record.format = format;
+        record.argc = 0;
+        record.string_bytes = 0;
+        record.suppressed = 0;
+        (capture(&record, args), ...);
+        if (mode == MODE_DIRECT) {
+            write_direct(record);
+        } else {
+            enqueue(site, record);
+        }
+    }
+
+    void set_mode(Mode mode) { mode_.store(mode, std::memory_order_relaxed); }
+    Mode mode() const { return mode_.load(std::memory_order_relaxed); }
+
+    // Replaces the kmsg sink; nullptr restores it.
+    void set_sink(Sink sink, void* context) {
+        std::lock_guard<std::mutex> lock(sink_mutex_);
+        sink_ = sink ? sink : klog_sink;
+        sink_context_ = sink ? context : nullptr;
+    }
+
+    // Waits until every message queued so far is written.
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this] { return count_ == 0 && !writing_; });
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+  private:
+    struct Arg {
+        enum Kind : uint8_t { INT, UINT, DOUBLE, STRING, POINTER } kind;
+        union {
+            int64_t i;
+            uint64_t u;
+            double d;
+            const void* p;
+            // Into Record::strings.
+            size_t offset;
+        };
+    };
+
+    struct Record {
+        int level;
+        const char* format;
+        int argc;
+        Arg args[kMaxArgs];
+        size_t string_bytes;
+        char strings[kStringBytes];
+        // Messages from the same site held back before this one.
+        int suppressed;
+    };
+
+    ChargerLog() : flusher_(&ChargerLog::flush_loop, this) {}
+
+    template <typename T>
+    static void capture(Record* record, const T& value) {
+        using D = std::decay_t<T>;
+        Arg& arg = record->args[record->argc++];
+        if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+            // Through a pointer: arrays decay here and are never null.
+            const char* s = value;
+            if (s == nullptr) s = "(null)";
+            size_t room = kStringBytes - record->string_bytes;
+            size_t length = room > 0 ? std::min(strlen(s), room - 1) : 0;
+            arg.kind = Arg::STRING;
+            arg.offset = record->string_bytes;
+            if (room > 0) {
+                memcpy(record->strings + record->string_bytes, s, length);
+                record->strings[record->string_bytes + length] = '\0';
+                record->string_bytes += length + 1;
+            } else {
+                arg.offset = kStringBytes;
+            }
+        } else if constexpr (std::is_floating_point_v<D>) {
+            arg.kind = Arg::DOUBLE;
+            arg.d = value;
+        } else if constexpr (std::is_enum_v<D> || std::is_signed_v<D>) {
+            arg.kind = Arg::INT;
+            arg.i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_integral_v<D>) {
+            arg.kind = Arg::UINT;
+            arg.u = static_cast<uint64_t>(value);
+        } else {
+            static_assert(std::is_pointer_v<D>, "unsupported ChargerLog argument");
+            arg.kind = Arg::POINTER;
+            arg.p = value;
+        }
+    }
+
+    static const char* string_arg(const Record& record, const Arg& arg) {
+        return arg.offset < kStringBytes ? record.strings + arg.offset : "";
+    }
+
+    // Identifies a message by its format and arguments.
+    static uint64_t hash(const Record& record) {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](uint64_t v) { h = (h ^ v) * 1099511628211ull; };
+        mix(reinterpret_cast<uintptr_t>(record.format));
+        for (int i = 0; i < record.argc; i++) {
+            const Arg& arg = record.args[i];
+            if (arg.kind != Arg::STRING) {
+                mix(arg.u);
+                continue;
+            }
+            for (const char* s = string_arg(record, arg); *s; s++) mix(static_cast<uint8_t>(*s));
+            mix(0);
+        }
+        return h;
+    }
+
+    static int64_t now_ms() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    // Spends the site's budget on a message; false if it is held back.
+    static bool admit(Site* site, uint64_t message, int64_t now) {
+        if (!site->primed) {
+            site->primed = true;
+            site->tokens = kBurst;
+            site->refill_ms = now;
+            site->last_hash = ~message;
+        }
+        if (message == site->last_hash && now - site->last_ms < kRepeatMs) return false;
+        if (site->tokens < kBurst && now - site->refill_ms >= kRefillMs) {
+            int64_t refills = (now - site->refill_ms) / kRefillMs;
+            site->tokens = static_cast<int>(std::min<int64_t>(site->tokens + refills, kBurst));
+            site->refill_ms += refills * kRefillMs;
+        }
+        if (site->tokens == 0) return false;
+        if (site->tokens == kBurst) site->refill_ms = now;
+        site->tokens--;
+        site->last_hash = message;
+        site->last_ms = now;
+        return true;
+    }
+
+    void enqueue(Site* site, Record& record) {
+        uint64_t message = hash(record);
+        int64_t now = now_ms();
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.logged++;
+            if (!admit(site, message, now)) {
+                site->suppressed++;
+                stats_.suppressed++;
+                return;
+            }
+            if (count_ == kRecords) {
+                stats_.dropped++;
+                return;
+            }
+            record.suppressed = site->suppressed;
+            site->suppressed = 0;
+            ring_[(head_ + count_) % kRecords] = record;
+            wake = count_++ == 0;
+        }
+        if (wake) work_cv_.notify_one();
+    }
+
+    void write_direct(const Record& record) {
+        write_record(record);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.logged++;
+        stats_.written++;
+    }
+
+    void flush_loop() {
+        uint64_t reported_dropped = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            work_cv_.wait(lock, [&] { return count_ > 0 || stats_.dropped != reported_dropped; });
+            uint64_t dropped = stats_.dropped - reported_dropped;
+            reported_dropped = stats_.dropped;
+            bool have = count_ > 0;
+            Record record;
+            if (have) {
+                record = ring_[head_];
+                head_ = (head_ + 1) % kRecords;
+                count_--;
+            }
+            writing_ = true;
+            lock.unlock();
+
+            char line[kLineLength];
+            if (dropped > 0) {
+                snprintf(line, sizeof(line), "%llu log messages lost\n",
+                         static_cast<unsigned long long>(dropped));
+                emit(KLOG_WARNING_LEVEL, line);
+            }
+            if (have) write_record(record);
+
+            lock.lock();
+            writing_ = false;
+            if (have) stats_.written++;
+            if (count_ == 0) idle_cv_.notify_all();
+        }
+    }
+
+    void write_record(const Record& record) {
+        char line[kLineLength];
+        if (record.suppressed > 0) {
+            snprintf(line, sizeof(line), "%d similar messages suppressed\n", record.suppressed);
+            emit(record.level, line);
+        }
+        format(record, line, sizeof(line));
+        emit(record.level, line);
+    }
+
+    void emit(int level, const char* line) {
+        std::lock_guard<std::mutex> lock(sink_mutex_);
+        sink_(level, line, sink_context_);
+    }
+
+    // Expands record.format with the captured arguments. Length modifiers are
+    // ignored, since the arguments were widened when captured.
+    static void format(const Record& record, char* out, size_t size) {
+        size_t n = 0;
+        int next = 0;
+        const char* f = record.format;
+        auto advance = [&](int length) {
+            if (length > 0) n = std::min(n + static_cast<size_t>(length), size - 1);
+        };
+        while (*f && n < size - 1) {
+            if (*f != '%' || f[1] == '%') {
+                out[n++] = *f;
+                f += *f == '%' ? 2 : 1;
+                continue;
+            }
+            char spec[24];
+            size_t s = 0;
+            spec[s++] = *f++;
+            while (*f && strchr("-+ #0123456789.", *f) && s < sizeof(spec) - 4) spec[s++] = *f++;
+            while (*f && strchr("hlLqjzt", *f)) f++;
+            char conversion = *f;
+            if (conversion) f++;
+            if (next >= record.argc || !strchr("diuoxXcsfFeEgGaAp", conversion)) {
+                advance(snprintf(out + n, size - n, "<?>"));
+                continue;
+            }
+            const Arg& arg = record.args[next++];
+            if (strchr("diuoxX", conversion)) {
+                spec[s++] = 'l';
+                spec[s++] = 'l';
+            }
+            spec[s++] = conversion;
+            spec[s] = '\0';
+            int length;
+            switch (conversion) {
+                case 'd':
+                case 'i':
+                    length = snprintf(out + n, size - n, spec, static_cast<long long>(arg.i));
+                    break;
+                case 'u':
+                case 'o':
+                case 'x':
+                case 'X':
+                    length = snprintf(out + n, size - n, spec,
+                                      static_cast<unsigned long long>(arg.u));
+                    break;
+                case 'c':
+                    length = snprintf(out + n, size - n, spec, static_cast<int>(arg.i));
+                    break;
+                case 's':
+                    length = snprintf(out + n, size - n, spec,
+                                      arg.kind == Arg::STRING ? string_arg(record, arg) : "?");
+                    break;
+                case 'p':
+                    length = snprintf(out + n, size - n, spec, arg.p);
+                    break;
+                default:
+                    length = snprintf(out + n, size - n, spec,
+                                      arg.kind == Arg::DOUBLE ? arg.d
+                                                              : static_cast<double>(arg.i));
+                    break;
+            }
+            advance(length);
+        }
+        out[n] = '\0';
+    }
+
+    static void klog_sink(int level, const char* line, void*) {
+        if (level <= KLOG_ERROR_LEVEL) {
+            KLOG_ERROR("charger", "%s", line);
+        } else if (level <= KLOG_WARNING_LEVEL) {
+            KLOG_WARNING("charger", "%s", line);
+        } else if (level <= KLOG_INFO_LEVEL) {
+            KLOG_INFO("charger", "%s", line);
+        } else {
+            KLOG_DEBUG("charger", "%s", line);
+        }
+    }
+
+    std::atomic<Mode> mode_{MODE_DEFERRED};
+    std::mutex mutex_;
+    // The flusher waits on work_cv_ for records; flush() waits on idle_cv_.
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    Record ring_[kRecords];
+    int head_ = 0;
+    int count_ = 0;
+    bool writing_ = false;
+    Stats stats_ = {};
+    std::mutex sink_mutex_;
+    Sink sink_ = klog_sink;
+    void* sink_context_ = nullptr;
+    // Started last, once the members it uses are.
+    std::thread flusher_;
+};
+
+// Logs at klog |level| from a call site with its own budget. Compiled out,
+// arguments and all, when |level| is above HEALTHD_DRAW_LOG_LEVEL.
+#define HEALTHD_DRAW_LOG(level, x...)                                   \
+    do {                                                                \
+        if (false) ChargerLog::check_format(x);                         \
+        if constexpr ((level) <= HEALTHD_DRAW_LOG_LEVEL) {              \
+            static ChargerLog::Site healthd_draw_log_site;              \
+            ChargerLog::get().log((level), &healthd_draw_log_site, x);  \
+        }                                                               \
+    } while (0)
+
+#endif  // HEALTHD_DRAW_LOG_H
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_MAILBOX_H
+#define HEALTHD_DRAW_MAILBOX_H
+
+#include <android-base/unique_fd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+
+// Single-slot mailbox handing the latest value from one producer thread to one
+// consumer thread. Values the consumer did not get to are overwritten, so it
+// always sees the newest one.
+//
+// It is a triple buffer: the producer fills its own slot and swaps it with the
+// shared one, the consumer swaps the shared one with its own. publish() never
+// blocks on the consumer; take() sleeps on an eventfd until something is new.
+template <typename T>
+class FrameMailbox {
+  public:
+    FrameMailbox() { event_fd_.reset(eventfd(0, EFD_CLOEXEC)); }
+
+    bool valid() const { return event_fd_.get() >= 0; }
+
+    // Producer side. Wait-free apart from the eventfd write, which never blocks.
+    void publish(const T& value) {
+        slots_[back_] = value;
+        int old = shared_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_ = old & kIndexMask;
+        if (old & kFresh) coalesced_.fetch_add(1, std::memory_order_relaxed);
+        published_.fetch_add(1, std::memory_order_relaxed);
+        wake();
+    }
+
+    // Consumer side. Blocks until a value newer than the last one taken was
+    // published and returns it; it stays valid until the next take(). Returns
+    // nullptr once close() was called.
+    const T* take() {
+        while (!closed_.load(std::memory_order_acquire)) {
+            if (shared_.load(std::memory_order_acquire) & kFresh) {
+                front_ = shared_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+                taken_.fetch_add(1, std::memory_order_relaxed);
+                return &slots_[front_];
+            }
+            uint64_t count;
+            if (TEMP_FAILURE_RETRY(read(event_fd_.get(), &count, sizeof(count))) < 0) break;
+        }
+        return nullptr;
+    }
+
+    // Makes take() return nullptr, now or once it wakes up.
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        wake();
+    }
+
+    // Lets take() block again after close(), dropping any value not taken yet.
+    // Only while no consumer is running.
+    void reopen() {
+        shared_.fetch_and(kIndexMask, std::memory_order_acq_rel);
+        closed_.store(false, std::memory_order_release);
+    }
+
+    // Values published, taken by the consumer, and overwritten before it took them.
+    int64_t published() const { return published_.load(std::memory_order_relaxed); }
+    int64_t taken() const { return taken_.load(std::memory_order_relaxed); }
+    int64_t coalesced() const { return coalesced_.load(std::memory_order_relaxed); }
+
+  private:
+    static constexpr int kIndexMask = 3;
+    static constexpr int kFresh = 4;
+
+    void wake() {
+        uint64_t one = 1;
+        (void)TEMP_FAILURE_RETRY(write(event_fd_.get(), &one, sizeof(one)));
+    }
+
+    T slots_[3] = {};
+    // Slot the producer fills next, and the one the consumer last took; only
+    // touched by their own thread.
+    int back_ = 0;
+    int front_ = 1;
+    // Slot in between, with kFresh set while it holds a value not yet taken.
+    std::atomic<int> shared_{2};
+    std::atomic<bool> closed_{false};
+    std::atomic<int64_t> published_{0};
+    std::atomic<int64_t> taken_{0};
+    std::atomic<int64_t> coalesced_{0};
+    android::base::unique_fd event_fd_;
+};
+
+#endif  // HEALTHD_DRAW_MAILBOX_H
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_MEMORY_H
+#define HEALTHD_DRAW_MEMORY_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "healthd_draw_backend.h"
+#include "healthd_draw_raster.h"
+
+// Headless HealthdDrawBackend rendering into memory, for running the charger UI
+// on a plain Linux host: no minui initialization, DRM or device required.
+// Counts the pixels each frame writes, times frames and dumps them as PPM.
+class MemoryDrawBackend : public HealthdDrawBackend {
+  public:
+    struct Config {
+        // Panel size in portrait (GRRotation::NONE) orientation.
+        int width = 1080;
+        int height = 2400;
+        PixelFormat format = PixelFormat::RGBX;
+        // Framebuffers are RGB565 instead, like a panel scanning it out natively.
+        bool rgb565 = false;
+        bool split_screen = false;
+        int split_offset = 0;
+        // See HealthdDrawBackend::render_threads().
+        int render_threads = 1;
+        // Framebuffers flipped between; 2 matches minui's double-buffered backends,
+        // so the back buffer holds the frame before the last one.
+        int buffers = 2;
+        // Connectors driven at once, each a panel of the size above with its own
+        // framebuffers and orientation.
+        int connectors = 1;
+        // minui decodes font PNGs on device. On a host the fonts are supplied
+        // directly: init_font() hands out |font| for any name.
+        const GRFont* sys_font = nullptr;
+        GRFont* font = nullptr;
+    };
+
+    struct Counters {
+        int64_t frames;
+        int64_t draw_calls;
+        // Framebuffer pixels written by fill, text and blit.
+        int64_t pixels_written;
+        // Time from the first draw call of a frame to its flip.
+        int64_t frame_ns;
+    };
+
+    explicit MemoryDrawBackend(const Config& config)
+        : config_(config), connectors_(std::max(config.connectors, 1)) {
+        for (Connector& connector : connectors_) {
+            allocate(&connector, config_.width, config_.height);
+        }
+    }
+
+    const Counters& last_frame() const { return last_frame_; }
+    const Counters& totals() const { return totals_; }
+    void reset_counters() {
+        frame_ = last_frame_ = totals_ = {};
+        frame_started_ = false;
+    }
+
+    // Last frame presented on connector |drm|, in its current orientation.
+    const GRSurface* front(int drm = 0) const {
+        const Connector& connector = connectors_[drm];
+        size_t count = connector.buffers.size();
+        return connector.buffers[(connector.current + count - 1) % count].get();
+    }
+
+    // Writes the last frame presented on connector |drm| as a binary PPM, in
+    // panel orientation.
+    bool dump_ppm(const char* path, int drm = 0) const {
+        FILE* file = fopen(path, "wbe");
+        if (file == nullptr) return false;
+        const GRSurface* surface = front(drm);
+        GRRotation rotation = connectors_[drm].rotation;
+        fprintf(file, "P6\n%d %d\n255\n", config_.width, config_.height);
+        std::vector<uint8_t> row(config_.width * 3);
+        for (int py = 0; py < config_.height; py++) {
+            for (int px = 0; px < config_.width; px++) {
+                // Inverse of the rotation applied when drawing.
+                int x = px, y = py;
+                if (rotation == GRRotation::RIGHT) {
+                    x = py;
+                    y = config_.width - 1 - px;
+                }
+                const uint8_t* pixel =
+                        surface->data() + y * surface->row_bytes + x * surface->pixel_bytes;
+                uint32_t r, g, b;
+                if (config_.rgb565) {
+                    raster_from_565(*reinterpret_cast<const uint16_t*>(pixel), &r, &g, &b);
+                } else {
+                    raster_unpack(config_.format, *reinterpret_cast<const uint32_t*>(pixel), &r,
+                                  &g, &b);
+                }
+                row[px * 3] = r;
+                row[px * 3 + 1] = g;
+                row[px * 3 + 2] = b;
+            }
+            fwrite(row.data(), 1, row.size(), file);
+        }
+        return fclose(file) == 0;
+    }
+
+    int width() override { return draw()->width; }
+    int height() override { return draw()->height; }
+    PixelFormat pixel_format() override { return config_.format; }
+    bool split_screen() override { return config_.split_screen; }
+    int split_offset() override { return config_.split_offset; }
+    int render_threads() override { return config_.render_threads; }
+
+    const GRFont* sys_font() override { return config_.sys_font; }
+    int init_font(const char* /* name */, GRFont** dest) override {
+        if (config_.font == nullptr) return -1;
+        *dest = config_.font;
+        return 0;
+    }
+    int measure(const GRFont* font, const char* str) override { return gr_measure(font, str); }
+    void color(unsigned char r, unsigned char g, unsigned char b, unsigned char a) override {
+        color_ = raster_pack(config_.rgb565 ? PixelFormat::ARGB : config_.format, r, g, b, a);
+    }
+    void clear() override { fill(0, 0, width(), height()); }
+    void fill(int x1, int y1, int x2, int y2) override {
+        begin_draw();
+        raster_fill(draw(), x1, y1, x2, y2, color_);
+        int w = std::min(x2, width()) - std::max(x1, 0);
+        int h = std::min(y2, height()) - std::max(y1, 0);
+        if (w > 0 && h > 0) frame_.pixels_written += static_cast<int64_t>(w) * h;
+    }
+    // Bold glyphs are not used by the charger and are drawn regular.
+    void text(const GRFont* font, int x, int y, const char* str, bool /* bold */) override {
+        begin_draw();
+        raster_text(draw(), font, x, y, str, color_);
+        frame_.pixels_written +=
+                static_cast<int64_t>(strlen(str)) * font->char_width * font->char_height;
+    }
+    void text_mask(const GRSurface* mask, int x, int y) override {
+        begin_draw();
+        raster_mask_rows(draw(), mask, x, y, color_, false /* dither */, 0, height());
+        frame_.pixels_written += static_cast<int64_t>(mask->width) * mask->height;
+    }
+    void blit(const GRSurface* source, int sx, int sy, int w, int h, int dx, int dy) override {
+        begin_draw();
+        raster_blit_convert(draw(), source, config_.format, sx, sy, w, h, dx, dy,
+                            false /* dither */);
+        frame_.pixels_written += static_cast<int64_t>(w) * h;
+    }
+
+    void flip(const std::vector<DrawRect>& /* damage */) override {
+        advance(&connectors_[selected_]);
+        end_frame();
+    }
+    // All connectors are flipped as one frame.
+    void flip_connectors(const int* drms, const std::vector<DrawRect>* const* /* damage */,
+                         int count) override {
+        for (int i = 0; i < count; i++) {
+            if (drms[i] >= 0 && drms[i] < connector_count()) advance(&connectors_[drms[i]]);
+        }
+        end_frame();
+    }
+    void blank(bool /* blank */, int /* drm */) override {}
+    void rotate(GRRotation rotation) override {
+        if (rotation != GRRotation::NONE && rotation != GRRotation::RIGHT) return;
+        Connector& connector = connectors_[selected_];
+        if (rotation == connector.rotation) return;
+        connector.rotation = rotation;
+        // Each orientation keeps its own framebuffers, allocated on first use.
+        connector.buffers.swap(connector.parked_buffers);
+        std::swap(connector.current, connector.parked_current);
+        if (!connector.buffers.empty()) return;
+        if (rotation == GRRotation::RIGHT) {
+            allocate(&connector, config_.height, config_.width);
+        } else {
+            allocate(&connector, config_.width, config_.height);
+        }
+    }
+    bool native_rgb565() override { return config_.rgb565; }
+    bool has_multiple_connectors() override { return connectors_.size() > 1; }
+    int connector_count() override { return connectors_.size(); }
+    bool select_connector(int drm) override {
+        if (drm < 0 || drm >= connector_count()) return false;
+        selected_ = drm;
+        return true;
+    }
+
+  private:
+    struct Connector {
+        // Surfaces are kept in drawing orientation; dump_ppm() turns them back.
+        std::vector<std::unique_ptr<GRSurface>> buffers;
+        size_t current = 0;
+        GRRotation rotation = GRRotation::NONE;
+        // Framebuffers of the other orientation.
+        std::vector<std::unique_ptr<GRSurface>> parked_buffers;
+        size_t parked_current = 0;
+    };
+
+    GRSurface* draw() {
+        Connector& connector = connectors_[selected_];
+        return connector.buffers[connector.current].get();
+    }
+
+    void allocate(Connector* connector, int width, int height) {
+        connector->buffers.clear();
+        for (int i = 0; i < std::max(config_.buffers, 1); i++) {
+            connector->buffers.push_back(
+                    raster_create(width, height, config_.rgb565 ? 2 : sizeof(uint32_t)));
+        }
+        connector->current = 0;
+    }
+
+    void advance(Connector* connector) {
+        connector->current = (connector->current + 1) % connector->buffers.size();
+    }
+
+    void end_frame() {
+        if (frame_started_) {
+            frame_.frame_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - frame_start_)
+                                      .count();
+        }
+        frame_.frames = 1;
+        last_frame_ = frame_;
+        totals_.frames++;
+        totals_.draw_calls += frame_.draw_calls;
+        totals_.pixels_written += frame_.pixels_written;
+        totals_.frame_ns += frame_.frame_ns;
+        frame_ = {};
+        frame_started_ = false;
+    }
+
+    void begin_draw() {
+        frame_.draw_calls++;
+        if (frame_started_) return;
+        frame_started_ = true;
+        frame_start_ = std::chrono::steady_clock::now();
+    }
+
+    Config config_;
+    std::vector<Connector> connectors_;
+    // Connector drawn to, as chosen by select_connector().
+    size_t selected_ = 0;
+    uint32_t color_ = 0xffffffff;
+
+    Counters frame_ = {};
+    Counters last_frame_ = {};
+    Counters totals_ = {};
+    bool frame_started_ = false;
+    std::chrono::steady_clock::time_point frame_start_;
+};
+
+#endif  // HEALTHD_DRAW_MEMORY_H
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_PROFILE_H
+#define HEALTHD_DRAW_PROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+// Per-stage timing of charger frames. Build with -DHEALTHD_DRAW_PROFILING=1 to
+// enable; otherwise FrameProfiler is empty and HEALTHD_PROFILE_STAGE does
+// nothing, so not even the clock is read.
+#ifndef HEALTHD_DRAW_PROFILING
+#define HEALTHD_DRAW_PROFILING 0
+#endif
+
+// Stages may nest: FRAME spans all others.
+enum FrameStage {
+    STAGE_FRAME,
+    STAGE_LAYOUT,
+    STAGE_STATIC_LAYER,
+    STAGE_ELEMENTS,
+    STAGE_CLEAR,
+    STAGE_PAINT,
+    STAGE_PRESENT,
+    STAGE_FLIP,
+    STAGE_COUNT
+};
+
+static constexpr const char* kFrameStageNames[STAGE_COUNT] = {
+        "frame", "layout", "static_layer", "elements", "clear", "paint", "present", "flip",
+};
+
+#if HEALTHD_DRAW_PROFILING
+
+// Latency histograms per stage and the records of the last kRecords frames.
+class FrameProfiler {
+  public:
+    // Bucket i counts durations in [2^(i-1), 2^i) microseconds; bucket 0 is under
+    // 1 us and the last one is open-ended.
+    static constexpr int kBuckets = 24;
+    static constexpr int kRecords = 64;
+    static constexpr uint32_t kBinaryMagic = 0x50464448;  // "HDFP"
+    static constexpr uint32_t kBinaryVersion = 1;
+
+    struct FrameRecord {
+        int64_t start_ns;
+        // 0 for stages the frame did not run.
+        int64_t stage_ns[STAGE_COUNT];
+    };
+
+    static int64_t now_ns() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    void begin_frame() {
+        current_ = {};
+        current_.start_ns = now_ns();
+    }
+    // Adds |ns| to |stage| of the frame being built.
+    void record(FrameStage stage, int64_t ns) { current_.stage_ns[stage] += ns; }
+    // Drops the frame being built, e.g. when it turned out not to need drawing.
+    void cancel_frame() { current_ = {}; }
+    void end_frame() {
+        for (int stage = 0; stage < STAGE_COUNT; stage++) {
+            int64_t ns = current_.stage_ns[stage];
+            if (ns > 0) histograms_[stage][bucket(ns)]++;
+        }
+        records_[frames_ % kRecords] = current_;
+        frames_++;
+    }
+
+    // Writes one line per stage with its histogram, then the last frames.
+    bool dump_text(FILE* file) const {
+        fprintf(file, "charger frame profile: %lld frames\n", static_cast<long long>(frames_));
+        for (int stage = 0; stage < STAGE_COUNT; stage++) {
+            fprintf(file, "%-14s", kFrameStageNames[stage]);
+            for (int b = 0; b < kBuckets; b++) {
+                fprintf(file, " %u", histograms_[stage][b]);
+            }
+            fputc('\n', file);
+        }
+        int64_t first = frames_ > kRecords ? frames_ - kRecords : 0;
+        for (int64_t frame = first; frame < frames_; frame++) {
+            const FrameRecord& record = records_[frame % kRecords];
+            fprintf(file, "frame %lld @%lld:", static_cast<long long>(frame),
+                    static_cast<long long>(record.start_ns));
+            for (int stage = 0; stage < STAGE_COUNT; stage++) {
+                if (record.stage_ns[stage] == 0) continue;
+                fprintf(file, " %s=%lld", kFrameStageNames[stage],
+                        static_cast<long long>(record.stage_ns[stage]));
+            }
+            fputc('\n', file);
+        }
+        return !ferror(file);
+    }
+
+    // Native-endian: magic, version, STAGE_COUNT, kBuckets, record count as
+    // uint32_t; the histograms as uint32_t[STAGE_COUNT][kBuckets]; then the
+    // records, oldest first, as FrameRecord.
+    bool dump_binary(FILE* file) const {
+        uint32_t count = frames_ > kRecords ? kRecords : static_cast<uint32_t>(frames_);
+        const uint32_t header[] = {kBinaryMagic, kBinaryVersion, STAGE_COUNT, kBuckets, count};
+        fwrite(header, sizeof(header), 1, file);
+        fwrite(histograms_, sizeof(histograms_), 1, file);
+        for (int64_t frame = frames_ - count; frame < frames_; frame++) {
+            fwrite(&records_[frame % kRecords], sizeof(FrameRecord), 1, file);
+        }
+        return !ferror(file);
+    }
+
+  private:
+    static int bucket(int64_t ns) {
+        int64_t us = ns / 1000;
+        int b = 0;
+        while (us > 0 && b < kBuckets - 1) {
+            us >>= 1;
+            b++;
+        }
+        return b;
+    }
+
+    FrameRecord current_ = {};
+    uint32_t histograms_[STAGE_COUNT][kBuckets] = {};
+    FrameRecord records_[kRecords] = {};
+    int64_t frames_ = 0;
+};
+
+// Records the time until the end of the scope under a stage, unless |profiler|
+// is nullptr, e.g. on threads the profiler does not belong to.
+class FrameStageTimer {
+  public:
+    FrameStageTimer(FrameProfiler* profiler, FrameStage stage)
+        : profiler_(profiler), stage_(stage), start_ns_(FrameProfiler::now_ns()) {}
+    ~FrameStageTimer() {
+        if (profiler_ != nullptr) profiler_->record(stage_, FrameProfiler::now_ns() - start_ns_);
+    }
+
+  private:
+    FrameProfiler* profiler_;
+    FrameStage stage_;
+    int64_t start_ns_;
+};
+
+#define HEALTHD_PROFILE_CONCAT_(a, b) a##b
+#define HEALTHD_PROFILE_CONCAT(a, b) HEALTHD_PROFILE_CONCAT_(a, b)
+#define HEALTHD_PROFILE_STAGE(profiler, stage) \
+    FrameStageTimer HEALTHD_PROFILE_CONCAT(stage_timer_, __LINE__)(profiler, stage)
+
+#else  // !HEALTHD_DRAW_PROFILING
+
+class FrameProfiler {
+  public:
+    void begin_frame() {}
+    void cancel_frame() {}
+    void end_frame() {}
+    bool dump_text(FILE*) const { return false; }
+    bool dump_binary(FILE*) const { return false; }
+};
+
+#define HEALTHD_PROFILE_STAGE(profiler, stage) \
+    do {                                       \
+        (void)(profiler);                      \
+    } while (0)
+
+#endif  // HEALTHD_DRAW_PROFILING
+
+#endif  // HEALTHD_DRAW_PROFILE_H
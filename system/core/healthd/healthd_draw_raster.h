@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_RASTER_H
+#define HEALTHD_DRAW_RASTER_H
+
+#include <minui/minui.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "healthd_draw_kernels.h"
+
+// Software rasterization into offscreen 32-bit GRSurfaces. minui only draws into
+// its own framebuffer, so anything cached off screen is rendered here with the
+// same pixel packing and blending rules gr_color()/gr_text() use, letting the
+// result be copied to the screen with gr_blit().
+//
+// Surfaces can also be RGB565 (pixel_bytes 2): red, green and blue in 5, 6 and 5
+// bits from the top, whatever the framebuffer format. Colors for them are packed
+// as ARGB, see raster_pack_for(). Quantizing to RGB565 can use a 4x4 ordered
+// dither, so a color between two RGB565 steps still comes out right on average.
+
+// Packs a color the way gr_color() does for |format|.
+static inline uint32_t raster_pack(PixelFormat format, unsigned char r, unsigned char g,
+                                   unsigned char b, unsigned char a) {
+    uint32_t r32 = r, g32 = g, b32 = b, a32 = a;
+    if (format == PixelFormat::ARGB || format == PixelFormat::BGRA) {
+        return (a32 << 24) | (r32 << 16) | (g32 << 8) | b32;
+    }
+    return (a32 << 24) | (b32 << 16) | (g32 << 8) | r32;
+}
+
+// Packs a color for drawing into |surface|: as gr_color() does for |format| if it
+// is 32-bit, as ARGB if it is RGB565.
+static inline uint32_t raster_pack_for(const GRSurface* surface, PixelFormat format,
+                                       unsigned char r, unsigned char g, unsigned char b,
+                                       unsigned char a) {
+    return raster_pack(surface->pixel_bytes == 2 ? PixelFormat::ARGB : format, r, g, b, a);
+}
+
+// Channels of a 32-bit pixel packed for |format|.
+static inline void raster_unpack(PixelFormat format, uint32_t pixel, uint32_t* r, uint32_t* g,
+                                 uint32_t* b) {
+    bool argb = format == PixelFormat::ARGB || format == PixelFormat::BGRA;
+    *r = (argb ? pixel >> 16 : pixel) & 0xff;
+    *g = (pixel >> 8) & 0xff;
+    *b = (argb ? pixel : pixel >> 16) & 0xff;
+}
+
+static constexpr uint8_t kRasterBayer4[4][4] = {
+        {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+// Added before truncating a channel to RGB565 at (x, y): the ordered-dither
+// threshold, or one half of a step to round to nearest.
+static inline uint32_t raster_threshold_565(bool dither, int x, int y) {
+    return dither ? kRasterBayer4[y & 3][x & 3] * 16 + 8 : 127;
+}
+
+static inline uint16_t raster_to_565(uint32_t r, uint32_t g, uint32_t b, uint32_t threshold) {
+    return ((r * 31 + threshold) / 255) << 11 | ((g * 63 + threshold) / 255) << 5 |
+           (b * 31 + threshold) / 255;
+}
+
+static inline void raster_from_565(uint16_t pixel, uint32_t* r, uint32_t* g, uint32_t* b) {
+    uint32_t r5 = pixel >> 11, g6 = (pixel >> 5) & 0x3f, b5 = pixel & 0x1f;
+    *r = r5 << 3 | r5 >> 2;
+    *g = g6 << 2 | g6 >> 4;
+    *b = b5 << 3 | b5 >> 2;
+}
+
+static inline uint32_t* raster_pixel(GRSurface* surface, int x, int y) {
+    return reinterpret_cast<uint32_t*>(surface->data() + y * surface->row_bytes) + x;
+}
+
+static inline uint16_t* raster_pixel_565(GRSurface* surface, int x, int y) {
+    return reinterpret_cast<uint16_t*>(surface->data() + y * surface->row_bytes) + x;
+}
+
+// Allocates a 32-bit surface, or an RGB565 one if |pixel_bytes| is 2, cleared to
+// zero.
+static inline std::unique_ptr<GRSurface> raster_create(int width, int height,
+                                                       size_t pixel_bytes = sizeof(uint32_t)) {
+    auto surface = GRSurface::Create(width, height, width * pixel_bytes, pixel_bytes);
+    if (surface) memset(surface->data(), 0, surface->row_bytes * surface->height);
+    return surface;
+}
+
+// Fills [x1, x2) x [y1, y2), clipped to the surface.
+static inline void raster_fill(GRSurface* surface, int x1, int y1, int x2, int y2,
+                               uint32_t color) {
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, static_cast<int>(surface->width));
+    y2 = std::min(y2, static_cast<int>(surface->height));
+    if (x2 <= x1) return;
+    if (surface->pixel_bytes == 2) {
+        uint16_t pixel = raster_to_565((color >> 16) & 0xff, (color >> 8) & 0xff, color & 0xff,
+                                       raster_threshold_565(false, 0, 0));
+        for (int y = y1; y < y2; y++) {
+            std::fill(raster_pixel_565(surface, x1, y), raster_pixel_565(surface, x2, y), pixel);
+        }
+        return;
+    }
+    const RasterKernels& kernels = raster_kernels();
+    for (int y = y1; y < y2; y++) kernels.fill(raster_pixel(surface, x1, y), x2 - x1, color);
+}
+
+// Copies a w x h block of |source| at (sx, sy) to (dx, dy). Like gr_blit(), the
+// copy is opaque and skipped entirely if it does not fit in |dest|.
+static inline void raster_blit(GRSurface* dest, const GRSurface* source, int sx, int sy, int w,
+                               int h, int dx, int dy) {
+    if (source->pixel_bytes != dest->pixel_bytes || w <= 0 || h <= 0) return;
+    if (dx < 0 || dy < 0 || dx + w > static_cast<int>(dest->width) ||
+        dy + h > static_cast<int>(dest->height)) {
+        return;
+    }
+    const size_t pixel_bytes = source->pixel_bytes;
+    const uint8_t* src = source->data() + sy * source->row_bytes + sx * pixel_bytes;
+    uint8_t* dst = dest->data() + dy * dest->row_bytes + dx * pixel_bytes;
+    for (int j = 0; j < h; j++) {
+        memcpy(dst, src, w * pixel_bytes);
+        src += source->row_bytes;
+        dst += dest->row_bytes;
+    }
+}
+
+// Copies a w x h block like raster_blit(), converting between 32-bit pixels packed
+// for |format| and RGB565 in either direction. Conversions to RGB565 are dithered
+// if |dither| is set.
+static inline void raster_blit_convert(GRSurface* dest, const GRSurface* source,
+                                       PixelFormat format, int sx, int sy, int w, int h, int dx,
+                                       int dy, bool dither) {
+    if (source->pixel_bytes == dest->pixel_bytes) {
+        raster_blit(dest, source, sx, sy, w, h, dx, dy);
+        return;
+    }
+    if (w <= 0 || h <= 0 || dx < 0 || dy < 0 || dx + w > static_cast<int>(dest->width) ||
+        dy + h > static_cast<int>(dest->height)) {
+        return;
+    }
+    const bool to_565 = dest->pixel_bytes == 2;
+    for (int j = 0; j < h; j++) {
+        const uint8_t* src = source->data() + (sy + j) * source->row_bytes;
+        uint8_t* dst = dest->data() + (dy + j) * dest->row_bytes;
+        for (int i = 0; i < w; i++) {
+            uint32_t r, g, b;
+            if (to_565) {
+                uint32_t pixel;
+                memcpy(&pixel, src + (sx + i) * sizeof(pixel), sizeof(pixel));
+                raster_unpack(format, pixel, &r, &g, &b);
+                uint16_t out = raster_to_565(r, g, b, raster_threshold_565(dither, dx + i, dy + j));
+                memcpy(dst + (dx + i) * sizeof(out), &out, sizeof(out));
+            } else {
+                uint16_t pixel;
+                memcpy(&pixel, src + (sx + i) * sizeof(pixel), sizeof(pixel));
+                raster_from_565(pixel, &r, &g, &b);
+                uint32_t out = raster_pack(format, r, g, b, 255);
+                memcpy(dst + (dx + i) * sizeof(out), &out, sizeof(out));
+            }
+        }
+    }
+}
+
+// Like raster_blit_convert(), but only writes rows [y1, y2) of |dest|, so
+// bands of one surface can be drawn concurrently. Whether the block fits is
+// still decided for all of it, and pixels come out as in a single call.
+static inline void raster_blit_convert_rows(GRSurface* dest, const GRSurface* source,
+                                            PixelFormat format, int sx, int sy, int w, int h,
+                                            int dx, int dy, bool dither, int y1, int y2) {
+    if (w <= 0 || h <= 0 || dx < 0 || dy < 0 || dx + w > static_cast<int>(dest->width) ||
+        dy + h > static_cast<int>(dest->height)) {
+        return;
+    }
+    int top = std::max(dy, y1);
+    int bottom = std::min(dy + h, y2);
+    if (bottom <= top) return;
+    raster_blit_convert(dest, source, format, sx, sy + top - dy, w, bottom - top, dx, top, dither);
+}
+
+// Blends like raster_blend_mask_scalar() over RGB565 pixels, the first of which
+// is at (x, y).
+static inline void raster_blend_mask_565(uint16_t* dst, const uint8_t* mask, int count,
+                                         uint32_t color, bool dither, int x, int y) {
+    uint8_t alpha_current = color >> 24;
+    uint32_t cr = (color >> 16) & 0xff, cg = (color >> 8) & 0xff, cb = color & 0xff;
+    for (int i = 0; i < count; i++) {
+        uint32_t a = mask[i];
+        if (alpha_current < 255) a = (a * alpha_current) / 255;
+        if (a == 0) continue;
+        uint32_t r, g, b;
+        raster_from_565(dst[i], &r, &g, &b);
+        r = (r * (255 - a) + cr * a) / 255;
+        g = (g * (255 - a) + cg * a) / 255;
+        b = (b * (255 - a) + cb * a) / 255;
+        dst[i] = raster_to_565(r, g, b, raster_threshold_565(dither, x + i, y));
+    }
+}
+
+// Like raster_text(), but only blends rows [y1, y2) of |surface|, so bands of
+// one surface can be drawn concurrently. Glyphs are still fitted against the
+// whole surface.
+static inline void raster_text_rows(GRSurface* surface, const GRFont* font, int x, int y,
+                                    const char* str, uint32_t color, bool dither, int y1,
+                                    int y2) {
+    if (!font || !font->texture || font->texture->pixel_bytes != 1 || (color >> 24) == 0) return;
+    const int first_row = std::max(y1 - y, 0);
+    const int last_row = std::min(y2 - y, font->char_height);
+    if (last_row <= first_row) return;
+    const RasterKernels& kernels = raster_kernels();
+    const int width = surface->width;
+    const int height = surface->height;
+    unsigned char ch;
+    while ((ch = *str++)) {
+        if (x < 0 || y < 0 || x + font->char_width > width || y + font->char_height > height) {
+            break;
+        }
+        if (ch < ' ' || ch > '~') ch = '?';
+        const uint8_t* src_row = font->texture->data() + (ch - ' ') * font->char_width +
+                                 first_row * font->texture->row_bytes;
+        for (int j = first_row; j < last_row; j++) {
+            if (surface->pixel_bytes == 2) {
+                raster_blend_mask_565(raster_pixel_565(surface, x, y + j), src_row,
+                                      font->char_width, color, dither, x, y + j);
+            } else {
+                kernels.blend_mask(raster_pixel(surface, x, y + j), src_row, font->char_width,
+                                   color);
+            }
+            src_row += font->texture->row_bytes;
+        }
+        x += font->char_width;
+    }
+}
+
+// Blends the coverage |mask|, one byte per pixel, at (x, y) in |color|, like
+// gr_texticon(), and only over rows [y1, y2). Each row is blended in one pass.
+// Nothing is drawn unless the whole mask fits.
+static inline void raster_mask_rows(GRSurface* surface, const GRSurface* mask, int x, int y,
+                                    uint32_t color, bool dither, int y1, int y2) {
+    if (!mask || mask->pixel_bytes != 1 || (color >> 24) == 0) return;
+    const int w = mask->width;
+    const int h = mask->height;
+    if (x < 0 || y < 0 || x + w > static_cast<int>(surface->width) ||
+        y + h > static_cast<int>(surface->height)) {
+        return;
+    }
+    const int first_row = std::max(y1 - y, 0);
+    const int last_row = std::min(y2 - y, h);
+    const RasterKernels& kernels = raster_kernels();
+    const uint8_t* src_row = mask->data() + first_row * mask->row_bytes;
+    for (int j = first_row; j < last_row; j++) {
+        if (surface->pixel_bytes == 2) {
+            raster_blend_mask_565(raster_pixel_565(surface, x, y + j), src_row, w, color, dither,
+                                  x, y + j);
+        } else {
+            kernels.blend_mask(raster_pixel(surface, x, y + j), src_row, w, color);
+        }
+        src_row += mask->row_bytes;
+    }
+}
+
+// Blends |str| in |font| at (x, y). Like gr_text(), stops at the first glyph that
+// would not fit and renders unprintable characters as '?'. On RGB565 surfaces
+// the result is dithered if |dither| is set.
+static inline void raster_text(GRSurface* surface, const GRFont* font, int x, int y,
+                               const char* str, uint32_t color, bool dither = false) {
+    raster_text_rows(surface, font, x, y, str, color, dither, 0,
+                     static_cast<int>(surface->height));
+}
+
+#endif  // HEALTHD_DRAW_RASTER_H
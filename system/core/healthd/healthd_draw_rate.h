@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_RATE_H
+#define HEALTHD_DRAW_RATE_H
+
+#include <batteryservice/BatteryService.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Charge rate and time to full, estimated from the battery level the charger
+// draws, in constant memory and constant time per update.
+//
+// Each time the level steps up while charging, a sample is added to a ring of
+// the last kCapacity steps, and two estimates are updated:
+//
+//  - an exponentially weighted rate over successive steps, which follows
+//    changes quickly;
+//  - a least-squares line through the steps of the last window, from running
+//    sums that gain the new step and lose the ones falling out of the window.
+//    The sums are integers, so they never drift however long the charger runs.
+//
+// The line is preferred once it has enough steps. Calls where the level did not
+// step only cost a comparison. Any other status, or a level going down,
+// restarts the estimate.
+class ChargeRateEstimator {
+  public:
+    static constexpr int kCapacity = 32;
+    // Readout text, e.g. " 18%/h  2h05": rate, then time to full. Fixed width,
+    // so it is laid out once.
+    static constexpr size_t kTextLength = 12;
+
+    struct Config {
+        // Steps older than this leave the regression.
+        int64_t window_ms = 10 * 60 * 1000;
+        // Weight of the newest step in the weighted rate.
+        double ewma_alpha = 0.5;
+        // Steps needed before the regression is preferred to the weighted rate.
+        int min_regression_samples = 4;
+        // Nothing is shown until steps have been seen over this long, nor once
+        // the level has not stepped for stale_ms.
+        int64_t min_span_ms = 3 * 60 * 1000;
+        int64_t stale_ms = 30 * 60 * 1000;
+        // Rates outside this range, in percent per hour, are not shown.
+        double min_rate = 0.5;
+        double max_rate = 400;
+        // The time to full is rounded up to this many minutes, so the text does
+        // not change at every step.
+        int round_minutes = 5;
+    };
+
+    struct Sample {
+        int64_t time_ms;
+        int level;
+    };
+
+    struct Estimate {
+        // Percent per hour, from the regression when it has enough steps, else
+        // the weighted rate; 0 if unknown.
+        double rate;
+        double ewma_rate;
+        double regression_rate;
+        // Rounded up to Config::round_minutes; -1 if unknown.
+        int minutes_to_full;
+        // Steps in the regression window.
+        int samples;
+        bool valid;
+    };
+
+    // The readout as drawn. Plain data, so a copy can be handed to another
+    // thread.
+    struct Text {
+        // Empty while there is no valid estimate.
+        char text[kTextLength + 4];
+        size_t length;
+        // Increments every time the text changes.
+        uint64_t generation;
+    };
+
+    ChargeRateEstimator() : ChargeRateEstimator(Config()) {}
+    explicit ChargeRateEstimator(const Config& config) : config_(config) {}
+
+    // Feeds the level and status drawn at |now_ms|. Returns true if text()
+    // changed.
+    bool add(int64_t now_ms, int level, int status) {
+        if (status != BATTERY_STATUS_CHARGING || level < 0 || level > 100 ||
+            (running_ && (level < level_ || now_ms < last_step_ms_))) {
+            restart(status == BATTERY_STATUS_CHARGING && level >= 0 && level <= 100, now_ms,
+                    level);
+            return publish();
+        }
+        if (!running_) {
+            restart(true, now_ms, level);
+            return publish();
+        }
+        if (level == level_) {
+            // No step: only the estimate going stale can change the text.
+            if (!estimate_.valid || now_ms - last_step_ms_ <= config_.stale_ms) return false;
+            estimate_.valid = false;
+            estimate_.minutes_to_full = -1;
+            return publish();
+        }
+
+        if (count_ == 0) {
+            // The first step: the time the level sat before it is unknown.
+            first_step_ms_ = now_ms;
+        } else {
+            int64_t elapsed_ms = std::max<int64_t>(now_ms - last_step_ms_, 1);
+            double rate = (level - level_) * kMsPerHour / elapsed_ms;
+            double alpha = steps_ == 0 ? 1 : config_.ewma_alpha;
+            ewma_ = alpha * rate + (1 - alpha) * ewma_;
+            steps_++;
+        }
+        level_ = level;
+        last_step_ms_ = now_ms;
+        push(now_ms, level);
+        update_estimate(now_ms);
+        return publish();
+    }
+
+    const Estimate& estimate() const { return estimate_; }
+    const Text& text() const { return text_; }
+    // Steps in the regression window, oldest first.
+    int sample_count() const { return count_; }
+    const Sample& sample(int i) const { return ring_[(head_ + i) % kCapacity]; }
+
+  private:
+    static constexpr double kMsPerHour = 3600.0 * 1000;
+    // The running sums are rebased onto the oldest step once the newest is this
+    // far from their origin, which keeps their terms small.
+    static constexpr int64_t kRebaseMs = 60 * 60 * 1000;
+
+    void restart(bool charging, int64_t now_ms, int level) {
+        running_ = charging;
+        level_ = level;
+        last_step_ms_ = now_ms;
+        count_ = 0;
+        head_ = 0;
+        n_ = sum_t_ = sum_l_ = sum_tt_ = sum_tl_ = 0;
+        steps_ = 0;
+        ewma_ = 0;
+        estimate_ = {};
+        estimate_.minutes_to_full = -1;
+    }
+
+    void push(int64_t time_ms, int level) {
+        // Drop what left the window, or the oldest step if the ring is full.
+        while (count_ > 0 &&
+               (count_ == kCapacity || time_ms - sample(0).time_ms > config_.window_ms)) {
+            const Sample& old = sample(0);
+            accumulate(old.time_ms, old.level, -1);
+            head_ = (head_ + 1) % kCapacity;
+            count_--;
+        }
+        // Empty sums are zero whatever their origin.
+        if (count_ == 0) {
+            origin_ms_ = time_ms;
+        } else if (time_ms - origin_ms_ > kRebaseMs) {
+            rebase(sample(0).time_ms);
+        }
+        ring_[(head_ + count_) % kCapacity] = {time_ms, level};
+        count_++;
+        accumulate(time_ms, level, 1);
+    }
+
+    void accumulate(int64_t time_ms, int level, int sign) {
+        int64_t t = time_ms - origin_ms_;
+        n_ += sign;
+        sum_t_ += sign * t;
+        sum_l_ += sign * level;
+        sum_tt_ += sign * t * t;
+        sum_tl_ += sign * t * level;
+    }
+
+    // Moves the origin of the sums to |origin_ms|: with s the shift, every t
+    // becomes t - s, and the sums follow without visiting the samples.
+    void rebase(int64_t origin_ms) {
+        int64_t s = origin_ms - origin_ms_;
+        sum_tt_ += -2 * s * sum_t_ + n_ * s * s;
+        sum_tl_ -= s * sum_l_;
+        sum_t_ -= n_ * s;
+        origin_ms_ = origin_ms;
+    }
+
+    void update_estimate(int64_t now_ms) {
+        estimate_.samples = count_;
+        estimate_.ewma_rate = ewma_;
+        estimate_.regression_rate = 0;
+        int64_t denominator = n_ * sum_tt_ - sum_t_ * sum_t_;
+        if (n_ >= 2 && denominator > 0) {
+            double slope = static_cast<double>(n_ * sum_tl_ - sum_t_ * sum_l_) / denominator;
+            estimate_.regression_rate = slope * kMsPerHour;
+        }
+        estimate_.rate = count_ >= config_.min_regression_samples ? estimate_.regression_rate
+                                                                   : estimate_.ewma_rate;
+        estimate_.valid = steps_ > 0 && now_ms - first_step_ms_ >= config_.min_span_ms &&
+                          estimate_.rate >= config_.min_rate && estimate_.rate <= config_.max_rate;
+        estimate_.minutes_to_full = -1;
+        if (estimate_.valid) {
+            int round = std::max(config_.round_minutes, 1);
+            double minutes = (100 - level_) * 60 / estimate_.rate;
+            int rounded = static_cast<int>(std::ceil(minutes / round)) * round;
+            estimate_.minutes_to_full = std::min(rounded, 99 * 60 + 59);
+        }
+    }
+
+    // Reformats the text from the estimate; returns true if it changed.
+    bool publish() {
+        Text text = {};
+        if (estimate_.valid) {
+            int rate = std::min(static_cast<int>(estimate_.rate + 0.5), 999);
+            text.length = snprintf(text.text, sizeof(text.text), "%3d%%/h %2dh%02d", rate,
+                                   estimate_.minutes_to_full / 60,
+                                   estimate_.minutes_to_full % 60);
+        }
+        if (text.length == text_.length && strcmp(text.text, text_.text) == 0) return false;
+        text.generation = text_.generation + 1;
+        text_ = text;
+        return true;
+    }
+
+    Config config_;
+    bool running_ = false;
+    // Level drawn last and when it last stepped up; the first step of this run.
+    int level_ = -1;
+    int64_t last_step_ms_ = 0;
+    int64_t first_step_ms_ = 0;
+    // Steps in the window, oldest at head_.
+    Sample ring_[kCapacity] = {};
+    int head_ = 0;
+    int count_ = 0;
+    // Sums over the window, with times relative to origin_ms_.
+    int64_t origin_ms_ = 0;
+    int64_t n_ = 0, sum_t_ = 0, sum_l_ = 0, sum_tt_ = 0, sum_tl_ = 0;
+    // Steps timed from the previous one, and their weighted rate.
+    int steps_ = 0;
+    double ewma_ = 0;
+    Estimate estimate_ = {0, 0, 0, -1, 0, false};
+    Text text_ = {};
+};
+
+#endif  // HEALTHD_DRAW_RATE_H
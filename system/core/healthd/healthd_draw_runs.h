@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_RUNS_H
+#define HEALTHD_DRAW_RUNS_H
+
+#include <minui/minui.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+
+// A string rasterized once in one font: the coverage of all its glyphs side by
+// side, one byte per pixel, ready to be blended in a single pass per row.
+struct GlyphRun {
+    static constexpr size_t kMaxText = 32;
+
+    const GRFont* font;
+    uint64_t hash;
+    char text[kMaxText];
+    // As measured when the run was made; the mask is this wide.
+    int width;
+    // Owned by GlyphRunCache; width and height are the run's, rows are packed.
+    GRSurface* mask;
+    // Frame in which the run was last looked up.
+    uint64_t frame;
+};
+
+// The runs of the texts drawn lately: the percent, clock and charge texts, and
+// those of the unknown-status screen. Fixed size: kEntries runs of at most
+// reserve() bytes each, allocated up front, so lookups never allocate. The run
+// used longest ago is replaced on a miss, but never one already used in the
+// current frame, as ops recorded earlier in the frame still point to it.
+// Texts are measured once, when their run is made.
+class GlyphRunCache {
+  public:
+    static constexpr int kEntries = 16;
+
+    // Returns the width of |str| drawn in |font|, e.g. with gr_measure().
+    using MeasureFunction = int (*)(void* context, const GRFont* font, const char* str);
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        // Misses that replaced another run.
+        uint64_t evictions;
+        // Misses that could not be cached: too large, or every run in use.
+        uint64_t bypassed;
+        int entries;
+        // Mask memory held.
+        size_t bytes;
+    };
+
+    // Until set, no text is cached.
+    void set_measure(MeasureFunction measure, void* context) {
+        measure_ = measure;
+        measure_context_ = context;
+    }
+
+    // Makes room for runs of up to |bytes| pixels. Only ever grows, and drops
+    // the runs it reallocates; those in use this frame grow once replaced.
+    void reserve(size_t bytes) {
+        if (bytes <= capacity_) return;
+        capacity_ = bytes;
+        for (Entry& entry : entries_) {
+            if (!entry.run.font || entry.run.frame != frame_) grow(&entry);
+        }
+    }
+
+    // Starts a frame: runs looked up from now on stay valid until the next call.
+    void begin_frame() { frame_++; }
+
+    // The run of |str| in |font|, rasterized on a miss; nullptr if it cannot be
+    // cached, in which case it is drawn glyph by glyph.
+    const GlyphRun* get(const GRFont* font, const char* str) {
+        size_t length = strlen(str);
+        if (!measure_ || !font || !font->texture || font->texture->pixel_bytes != 1 ||
+            length == 0 || length >= GlyphRun::kMaxText) {
+            stats_.bypassed++;
+            return nullptr;
+        }
+        uint64_t hash = hash_of(font, str);
+        Entry* victim = nullptr;
+        for (Entry& entry : entries_) {
+            GlyphRun& run = entry.run;
+            if (run.font == font && run.hash == hash && strcmp(run.text, str) == 0) {
+                run.frame = frame_;
+                stats_.hits++;
+                return &run;
+            }
+            if (run.frame == frame_ && run.font) continue;
+            if (!victim || !run.font || (victim->run.font && run.frame < victim->run.frame)) {
+                victim = &entry;
+            }
+        }
+        stats_.misses++;
+        int width = measure_(measure_context_, font, str);
+        size_t bytes = static_cast<size_t>(std::max(width, 0)) * font->char_height;
+        if (victim && victim->capacity < capacity_) grow(victim);
+        if (!victim || width <= 0 || bytes > victim->capacity) {
+            stats_.bypassed++;
+            return nullptr;
+        }
+        if (victim->run.font) {
+            stats_.evictions++;
+        } else {
+            stats_.entries++;
+        }
+        rasterize(victim->surface.get(), font, str, length, width);
+        GlyphRun& run = victim->run;
+        run.font = font;
+        run.hash = hash;
+        memcpy(run.text, str, length + 1);
+        run.width = width;
+        run.mask = victim->surface.get();
+        run.frame = frame_;
+        return &run;
+    }
+
+    const Stats& stats() const { return stats_; }
+
+  private:
+    struct Entry {
+        std::unique_ptr<GRSurface> surface;
+        size_t capacity;
+        GlyphRun run;
+    };
+
+    void grow(Entry* entry) {
+        entry->surface = GRSurface::Create(capacity_, 1, capacity_, 1);
+        size_t capacity = entry->surface ? capacity_ : 0;
+        stats_.bytes = stats_.bytes - entry->capacity + capacity;
+        entry->capacity = capacity;
+        if (entry->run.font) stats_.entries--;
+        entry->run = {};
+    }
+
+    static uint64_t hash_of(const GRFont* font, const char* str) {
+        uint64_t h = 1469598103934665603ull ^ reinterpret_cast<uintptr_t>(font);
+        for (; *str; str++) h = (h ^ static_cast<uint8_t>(*str)) * 1099511628211ull;
+        return h;
+    }
+
+    // Copies the glyphs of |str| side by side into |mask|, which becomes |width|
+    // wide and a glyph high. Glyphs advance by the font's cell width, as with
+    // gr_text(); past the last one the mask is blank. Unprintable characters
+    // become '?', as with gr_text().
+    static void rasterize(GRSurface* mask, const GRFont* font, const char* str, size_t length,
+                          int width) {
+        const int cw = font->char_width;
+        mask->width = width;
+        mask->height = font->char_height;
+        mask->row_bytes = mask->width;
+        if (width > static_cast<int>(length) * cw) {
+            memset(mask->data(), 0, mask->row_bytes * mask->height);
+        }
+        const GRSurface* texture = font->texture;
+        for (size_t i = 0; i < length && static_cast<int>(i) * cw < width; i++) {
+            unsigned char ch = str[i];
+            if (ch < ' ' || ch > '~') ch = '?';
+            const int columns = std::min(cw, width - static_cast<int>(i) * cw);
+            const uint8_t* src = texture->data() + (ch - ' ') * cw;
+            uint8_t* dst = mask->data() + i * cw;
+            for (int j = 0; j < font->char_height; j++) {
+                memcpy(dst, src, columns);
+                src += texture->row_bytes;
+                dst += mask->row_bytes;
+            }
+        }
+    }
+
+    Entry entries_[kEntries] = {};
+    MeasureFunction measure_ = nullptr;
+    void* measure_context_ = nullptr;
+    size_t capacity_ = 0;
+    uint64_t frame_ = 1;
+    Stats stats_ = {};
+};
+
+#endif  // HEALTHD_DRAW_RUNS_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_TILES_H
+#define HEALTHD_DRAW_TILES_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads that compose the horizontal bands of a frame in
+// parallel. The calling thread takes bands too, and run() only returns once
+// every band is done, so nothing is left drawing when the frame is flipped.
+// Threads are started with the pool and kept: run() starts no threads and
+// allocates nothing.
+class TilePool {
+  public:
+    using Task = void (*)(void* context, int band);
+
+    // |threads| counts the calling thread, so a pool of one starts none.
+    explicit TilePool(int threads) {
+        workers_.reserve(std::max(threads - 1, 0));
+        for (int i = 1; i < threads; i++) workers_.emplace_back(&TilePool::worker_loop, this);
+    }
+
+    ~TilePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            exit_ = true;
+        }
+        work_cv_.notify_all();
+        for (std::thread& worker : workers_) worker.join();
+    }
+
+    TilePool(const TilePool&) = delete;
+    TilePool& operator=(const TilePool&) = delete;
+
+    int threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+    // Runs task(context, band) for every band in [0, count), spread over the
+    // pool, and waits for all of them. Bands are handed out one at a time, so
+    // cheap ones do not hold a thread up. Not reentrant.
+    void run(int count, Task task, void* context) {
+        if (workers_.empty() || count <= 1) {
+            for (int band = 0; band < count; band++) task(context, band);
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // A worker that woke late for the previous run may still be looking
+            // for a band of it.
+            done_cv_.wait(lock, [this] { return active_ == 0; });
+            task_ = task;
+            context_ = context;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            remaining_ = count;
+            generation_++;
+        }
+        work_cv_.notify_all();
+        int done = take_bands(task, context, count);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        remaining_ -= done;
+        done_cv_.wait(lock, [this] { return remaining_ == 0; });
+    }
+
+  private:
+    // Runs bands until none are left; returns how many this thread ran.
+    int take_bands(Task task, void* context, int count) {
+        int done = 0;
+        int band;
+        while ((band = next_.fetch_add(1, std::memory_order_relaxed)) < count) {
+            task(context, band);
+            done++;
+        }
+        return done;
+    }
+
+    void worker_loop() {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            work_cv_.wait(lock, [&] { return exit_ || generation_ != seen; });
+            if (exit_) return;
+            seen = generation_;
+            Task task = task_;
+            void* context = context_;
+            int count = count_;
+            active_++;
+            lock.unlock();
+            int done = take_bands(task, context, count);
+            lock.lock();
+            active_--;
+            remaining_ -= done;
+            if (remaining_ == 0 || active_ == 0) done_cv_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    // Workers wait on work_cv_ for a new run; run() waits on done_cv_ for its
+    // bands and for workers still busy with an older run.
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    // The current run, published under mutex_.
+    Task task_ = nullptr;
+    void* context_ = nullptr;
+    int count_ = 0;
+    uint64_t generation_ = 0;
+    // Next band to hand out; bands not yet finished; workers inside a run.
+    std::atomic<int> next_{0};
+    int remaining_ = 0;
+    int active_ = 0;
+    bool exit_ = false;
+};
+
+#endif  // HEALTHD_DRAW_TILES_H
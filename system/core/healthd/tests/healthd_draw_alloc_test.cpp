@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <new>
+
+#include "healthd_draw_test_utils.h"
+
+// Every allocation of the test binary, on any thread, is counted while
+// |counting| is set.
+static std::atomic<bool> counting{false};
+static std::atomic<int64_t> allocations{0};
+
+void* operator new(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) allocations++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    if (counting.load(std::memory_order_relaxed)) allocations++;
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+struct AllocationCase {
+    const char* name;
+    int width;
+    int height;
+    bool split;
+    int connectors;
+    int render_threads;
+    bool render_thread;
+};
+
+class HealthdDrawAllocationTest : public testing::TestWithParam<AllocationCase> {};
+
+// Once every screen has been drawn, in both orientations, frames draw without
+// allocating: levels, animation frames and statuses change, the screen rotates,
+// and nothing is allocated for thousands of frames.
+TEST_P(HealthdDrawAllocationTest, SteadyStateFramesDoNotAllocate) {
+    const AllocationCase& c = GetParam();
+    constexpr int kFrames = 2000;
+    TestCharger charger;
+    MemoryDrawBackend::Config config = charger.config(c.width, c.height);
+    config.split_screen = c.split;
+    config.split_offset = c.split ? 10 : 0;
+    config.connectors = c.connectors;
+    config.render_threads = c.render_threads;
+    animation anim = charger.make_animation();
+    std::unique_ptr<HealthdDraw> draw =
+            HealthdDraw::Create(&anim, std::make_unique<MemoryDrawBackend>(config));
+    if (c.connectors > 1) draw->blank_screen(false, 1);
+    if (c.render_thread) {
+        ASSERT_TRUE(draw->start_render_thread(&anim));
+    }
+
+    auto frame = [&](int i) {
+        anim.cur_level = i % 101;
+        // Whole-screen changes now and then, which tiled panels compose in bands.
+        anim.cur_status = i % 7 == 6 ? BATTERY_STATUS_UNKNOWN : BATTERY_STATUS_CHARGING;
+        if (i % 500 == 0) draw->rotate_screen(i % 1000 ? 0 : 1);
+        draw->redraw_screen(&anim, nullptr);
+        if (c.render_thread) usleep(100);
+    };
+    // Through both orientations and both screens first.
+    for (int i = 0; i < 1000; i += 10) frame(i);
+
+    int64_t presented = draw->frame_counters().presented;
+    allocations = 0;
+    counting = true;
+    for (int i = 0; i < kFrames; i++) frame(i);
+    counting = false;
+    if (c.render_thread) draw->stop_render_thread();
+
+    EXPECT_EQ(0, allocations.load());
+    EXPECT_GT(draw->frame_counters().presented - presented, kFrames / 2);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        Screens, HealthdDrawAllocationTest,
+        testing::Values(AllocationCase{"single", 400, 700, false, 1, 1, false},
+                        AllocationCase{"split", 400, 700, true, 1, 1, false},
+                        AllocationCase{"two_connectors", 400, 700, false, 2, 1, false},
+                        AllocationCase{"render_thread", 400, 700, false, 1, 1, true},
+                        AllocationCase{"tiled", 720, 1280, false, 1, 2, false}),
+        [](const testing::TestParamInfo<AllocationCase>& info) { return info.param.name; });
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "healthd_draw_kernels.h"
+#include "healthd_draw_log.h"
+#include "healthd_draw_test_utils.h"
+
+// A HealthdDraw on a MemoryDrawBackend panel, full HD+ unless said otherwise.
+struct BenchmarkScreen {
+    explicit BenchmarkScreen(int render_threads = 1, int width = 1080, int height = 2400,
+                             bool split = false) {
+        MemoryDrawBackend::Config config = charger.config(width, height);
+        config.render_threads = render_threads;
+        config.split_screen = split;
+        config.split_offset = split ? 10 : 0;
+        anim = charger.make_animation();
+        backend = new MemoryDrawBackend(config);
+        draw = HealthdDraw::Create(&anim, std::unique_ptr<HealthdDrawBackend>(backend));
+    }
+
+    TestCharger charger;
+    animation anim;
+    MemoryDrawBackend* backend;
+    std::unique_ptr<HealthdDraw> draw;
+};
+
+// Frames alternating the battery screen with the unknown-status one, so that
+// each clears and composes the whole panel, on 1 to 4 render threads. One
+// thread draws straight to the framebuffer, as a device does by default; more
+// compose offscreen in bands and copy the result, which is not parallel.
+static void BM_FullFrame(benchmark::State& state) {
+    BenchmarkScreen screen(state.range(0));
+    int i = 0;
+    for (auto _ : state) {
+        screen.anim.cur_status = i++ % 2 ? BATTERY_STATUS_UNKNOWN : BATTERY_STATUS_CHARGING;
+        screen.draw->redraw_screen(&screen.anim, nullptr);
+    }
+    state.counters["bands"] = screen.draw->last_frame_stats().bands;
+}
+BENCHMARK(BM_FullFrame)->DenseRange(1, 4)->UseRealTime();
+
+// Frames stepping the level by one, so that only the percent text changes and
+// frames stay on the drawing thread whatever the thread count.
+static void BM_LevelFrame(benchmark::State& state) {
+    BenchmarkScreen screen(state.range(0));
+    screen.draw->redraw_screen(&screen.anim, nullptr);
+    int i = 0;
+    for (auto _ : state) {
+        screen.anim.cur_level = 10 + i++ % 80;
+        screen.draw->redraw_screen(&screen.anim, nullptr);
+    }
+    state.counters["bands"] = screen.draw->last_frame_stats().bands;
+}
+BENCHMARK(BM_LevelFrame)->DenseRange(1, 4)->UseRealTime();
+
+// Frames of a split-screen panel against the same panel whole, on one thread:
+// full frames switching screens, and level frames. Split screens are drawn
+// once into a half-width canvas and copied to both halves, so they should cost
+// about as much as whole ones, not twice as much: full frames only add clearing
+// the canvas, since just what was drawn on it is copied.
+static void BM_SplitScreen(benchmark::State& state) {
+    bool split = state.range(0);
+    bool full = state.range(1);
+    BenchmarkScreen screen(1, 1080, 2400, split);
+    screen.draw->redraw_screen(&screen.anim, nullptr);
+    int i = 0;
+    for (auto _ : state) {
+        if (full) {
+            screen.anim.cur_status = i % 2 ? BATTERY_STATUS_UNKNOWN : BATTERY_STATUS_CHARGING;
+        }
+        screen.anim.cur_level = 10 + i++ % 80;
+        screen.draw->redraw_screen(&screen.anim, nullptr);
+    }
+    state.counters["bytes_written"] = screen.draw->last_frame_stats().bytes_written;
+}
+BENCHMARK(BM_SplitScreen)->ArgNames({"split", "full"})->ArgsProduct({{0, 1}, {1, 0}});
+
+static void null_sink(int, const char* line, void* context) {
+    ssize_t unused = write(*static_cast<int*>(context), line, strlen(line));
+    (void)unused;
+}
+
+// Level frames with ChargerLog off, writing each message on the drawing thread
+// as plain KLOG did, and deferring them to its flusher, written to /dev/null.
+// A 200x200 panel keeps drawing from drowning out the logging. Only call sites
+// compiled in can cost anything: with the default HEALTHD_DRAW_LOG_LEVEL the
+// per-frame LOGV sites are gone, and every mode draws the same code.
+static void BM_LevelFrameLogging(benchmark::State& state) {
+    ChargerLog& log = ChargerLog::get();
+    int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    log.set_sink(null_sink, &fd);
+    BenchmarkScreen screen(1, 200, 200);
+    screen.draw->redraw_screen(&screen.anim, nullptr);
+    log.flush();
+
+    log.set_mode(static_cast<ChargerLog::Mode>(state.range(0)));
+    ChargerLog::Stats before = log.stats();
+    int i = 0;
+    for (auto _ : state) {
+        screen.anim.cur_level = 10 + i++ % 80;
+        screen.draw->redraw_screen(&screen.anim, nullptr);
+    }
+    log.flush();
+    ChargerLog::Stats after = log.stats();
+    log.set_mode(ChargerLog::MODE_DEFERRED);
+    log.set_sink(nullptr, nullptr);
+    close(fd);
+
+    using benchmark::Counter;
+    state.counters["logged"] = Counter(after.logged - before.logged, Counter::kAvgIterations);
+    state.counters["written"] = Counter(after.written - before.written, Counter::kAvgIterations);
+    state.counters["suppressed"] =
+            Counter(after.suppressed - before.suppressed, Counter::kAvgIterations);
+    state.counters["dropped"] = Counter(after.dropped - before.dropped, Counter::kAvgIterations);
+}
+BENCHMARK(BM_LevelFrameLogging)
+        ->ArgName("mode")
+        ->Arg(ChargerLog::MODE_OFF)
+        ->Arg(ChargerLog::MODE_DIRECT)
+        ->Arg(ChargerLog::MODE_DEFERRED);
+
+// Kernel sets by name; the widest ones the CPU lacks are skipped.
+static const RasterKernels* kernels_for(benchmark::State& state) {
+    switch (state.range(0)) {
+        case 0:
+            return &kScalarRasterKernels;
+#if defined(HEALTHD_KERNELS_X86) && defined(__SSE2__)
+        case 1:
+            return &kSse2RasterKernels;
+        case 2:
+            if (__builtin_cpu_supports("avx2")) return &kAvx2RasterKernels;
+            break;
+#elif defined(HEALTHD_KERNELS_NEON)
+        case 1:
+            return &kNeonRasterKernels;
+#endif
+    }
+    state.SkipWithError("kernels not supported");
+    return nullptr;
+}
+
+// Throughput of blending one row of glyph coverage the width of a full HD+
+// panel, coverage mixing none, full and partial like antialiased text.
+static void BM_BlendMask(benchmark::State& state) {
+    const RasterKernels* kernels = kernels_for(state);
+    if (kernels == nullptr) return;
+    constexpr int kPixels = 1080;
+    std::mt19937 rng(1);
+    std::vector<uint32_t> pixels(kPixels, 0xff102030);
+    std::vector<uint8_t> mask(kPixels);
+    for (uint8_t& coverage : mask) {
+        int kind = rng() % 3;
+        coverage = kind == 0 ? 0 : kind == 1 ? 255 : rng();
+    }
+    state.SetLabel(kernels->name);
+    for (auto _ : state) {
+        kernels->blend_mask(pixels.data(), mask.data(), kPixels, 0xff40c080);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+}
+BENCHMARK(BM_BlendMask)->DenseRange(0, 2);
+
+// Throughput of filling one full HD+ row.
+static void BM_Fill(benchmark::State& state) {
+    const RasterKernels* kernels = kernels_for(state);
+    if (kernels == nullptr) return;
+    constexpr int kPixels = 1080;
+    std::vector<uint32_t> pixels(kPixels);
+    state.SetLabel(kernels->name);
+    for (auto _ : state) {
+        kernels->fill(pixels.data(), kPixels, 0xff000000);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+}
+BENCHMARK(BM_Fill)->DenseRange(0, 2);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android-base/properties.h>
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include "healthd_draw_test_utils.h"
+
+// The decoded frames HealthdDraw is created with are freed once compressed,
+// and frames are drawn from the compressed copies.
+TEST(AnimationFrames, SurfacesHandedOverWhenCompressed) {
+    TestCharger charger;
+    animation anim = charger.make_animation();
+    MemoryDrawBackend* backend = new MemoryDrawBackend(charger.config(400, 700));
+    std::unique_ptr<HealthdDraw> draw =
+            HealthdDraw::Create(&anim, std::unique_ptr<HealthdDrawBackend>(backend));
+    EXPECT_EQ(nullptr, anim.frames[0].surface);
+    AnimationFrameStore::Stats stats = draw->frame_store_stats();
+    EXPECT_EQ(1u, stats.frames);
+    EXPECT_GT(stats.encoded_bytes, 0u);
+    EXPECT_LT(stats.encoded_bytes, stats.frame_bytes);
+
+    draw->redraw_screen(&anim, nullptr);
+    EXPECT_EQ(1, draw->frame_counters().presented);
+    EXPECT_EQ(stats.frame_bytes, draw->frame_store_stats().decoded_bytes);
+}
+
+// Frames that cannot be compressed stay the caller's and are drawn as they are.
+TEST(AnimationFrames, SurfacesKeptWhenNotCompressed) {
+    TestCharger charger;
+    animation anim = charger.make_animation();
+    std::unique_ptr<GRSurface> gray = GRSurface::Create(TestCharger::kFrameSize,
+                                                        TestCharger::kFrameSize,
+                                                        TestCharger::kFrameSize, 1);
+    GRSurface* frame = anim.frames[0].surface;
+    anim.frames[0].surface = gray.get();
+    MemoryDrawBackend* backend = new MemoryDrawBackend(charger.config(400, 700));
+    std::unique_ptr<HealthdDraw> draw =
+            HealthdDraw::Create(&anim, std::unique_ptr<HealthdDrawBackend>(backend));
+    EXPECT_EQ(gray.get(), anim.frames[0].surface);
+    EXPECT_EQ(0u, draw->frame_store_stats().frames);
+    anim.frames[0].surface = frame;
+}
+
+// |count| 32-bit frames of TestCharger::kFrameSize, each a different color,
+// noisy unless |flat| so that they hardly compress.
+static std::vector<std::unique_ptr<GRSurface>> make_frames(int count, bool flat) {
+    std::vector<std::unique_ptr<GRSurface>> frames;
+    uint32_t noise = 1;
+    for (int i = 0; i < count; i++) {
+        frames.push_back(GRSurface::Create(TestCharger::kFrameSize, TestCharger::kFrameSize,
+                                           TestCharger::kFrameSize * 4, sizeof(uint32_t)));
+        uint32_t* pixels = reinterpret_cast<uint32_t*>(frames.back()->data());
+        for (int p = 0; p < TestCharger::kFrameSize * TestCharger::kFrameSize; p++) {
+            noise = noise * 1103515245 + 12345;
+            pixels[p] = 0xff000000 | (i * 0x30) | (flat ? 0 : (noise >> 8) & 0xffff00);
+        }
+    }
+    return frames;
+}
+
+static uint32_t first_pixel(const GRSurface* surface) {
+    return *reinterpret_cast<const uint32_t*>(surface->data());
+}
+
+// A budget holding a single decoded frame still shows every frame, decoding
+// each over the last one, and prefetches nothing.
+TEST(AnimationFrames, OneDecodedFrameWithoutPrefetch) {
+    std::vector<std::unique_ptr<GRSurface>> frames = make_frames(4, true);
+    size_t frame_bytes = frames[0]->row_bytes * frames[0]->height;
+    AnimationFrameStore probe(SIZE_MAX);
+    for (const auto& frame : frames) probe.add(frame.get());
+    AnimationFrameStore store(probe.stats().encoded_bytes + frame_bytes);
+    for (const auto& frame : frames) store.add(frame.get());
+    ASSERT_EQ(AnimationFrameStore::FALLBACK_NO_PREFETCH, store.fit_budget());
+
+    for (int i = 0; i < 8; i++) {
+        int index = i % 4;
+        GRSurface* surface = store.get(index);
+        ASSERT_NE(nullptr, surface);
+        EXPECT_EQ(index, store.shown());
+        EXPECT_EQ(first_pixel(frames[index].get()), first_pixel(surface));
+        store.prefetch((index + 1) % 4);
+    }
+    const AnimationFrameStore::Stats& stats = store.stats();
+    EXPECT_EQ(1u, stats.cache_capacity);
+    EXPECT_EQ(0, stats.prefetches);
+    EXPECT_LE(stats.peak_resident_bytes, stats.budget_bytes);
+}
+
+// A budget too small for that keeps the last frame alone, decoded, and shows it
+// for every frame.
+TEST(AnimationFrames, StaticFrameWhenNoneFitsBesideTheRest) {
+    std::vector<std::unique_ptr<GRSurface>> frames = make_frames(4, false);
+    size_t frame_bytes = frames[0]->row_bytes * frames[0]->height;
+    AnimationFrameStore last(SIZE_MAX);
+    last.add(frames[3].get());
+    AnimationFrameStore store(last.stats().encoded_bytes + frame_bytes);
+    for (const auto& frame : frames) store.add(frame.get());
+    ASSERT_EQ(AnimationFrameStore::FALLBACK_STATIC_FRAME, store.fit_budget());
+
+    EXPECT_EQ(4u, store.size());
+    for (int i = 0; i < 4; i++) {
+        GRSurface* surface = store.get(i);
+        ASSERT_NE(nullptr, surface);
+        EXPECT_EQ(3, store.shown());
+        EXPECT_EQ(first_pixel(frames[3].get()), first_pixel(surface));
+    }
+    const AnimationFrameStore::Stats& stats = store.stats();
+    EXPECT_EQ(0u, stats.encoded_bytes);
+    EXPECT_LE(stats.peak_resident_bytes, stats.budget_bytes);
+}
+
+TEST(AnimationFrames, NoFramesWhenNotEvenOneFits) {
+    std::vector<std::unique_ptr<GRSurface>> frames = make_frames(4, false);
+    size_t frame_bytes = frames[0]->row_bytes * frames[0]->height;
+    AnimationFrameStore store(frame_bytes);
+    for (const auto& frame : frames) store.add(frame.get());
+    ASSERT_EQ(AnimationFrameStore::FALLBACK_NO_FRAMES, store.fit_budget());
+
+    EXPECT_EQ(nullptr, store.get(0));
+    EXPECT_EQ(nullptr, store.get(3));
+    EXPECT_EQ(0u, store.stats().encoded_bytes + store.stats().decoded_bytes);
+}
+
+// With one decoded frame, every frame is drawn into the same surface: frames
+// must still be told apart, or nothing would be repainted after the first.
+TEST(AnimationFrames, SingleSlotFramesAreRedrawn) {
+    TestCharger charger;
+    animation anim = charger.make_animation();
+    std::vector<std::unique_ptr<GRSurface>> surfaces = make_frames(2, true);
+    animation::frame frames[2] = {};
+    for (int i = 0; i < 2; i++) {
+        frames[i].max_level = 100;
+        frames[i].surface = surfaces[i].release();
+    }
+    anim.frames = frames;
+    anim.num_frames = 2;
+    // Room for one decoded 16 KB frame, and the compressed ones.
+    android::base::SetProperty("ro.charger.frame_budget_kb", "17");
+    MemoryDrawBackend* backend = new MemoryDrawBackend(charger.config(400, 700));
+    std::unique_ptr<HealthdDraw> draw =
+            HealthdDraw::Create(&anim, std::unique_ptr<HealthdDrawBackend>(backend));
+    android::base::SetProperty("ro.charger.frame_budget_kb", "");
+    ASSERT_EQ(AnimationFrameStore::FALLBACK_NO_PREFETCH, draw->frame_store_stats().fallback);
+
+    anim.run = true;
+    for (int i = 0; i < 4; i++) {
+        anim.cur_frame = i % 2;
+        draw->redraw_screen(&anim, nullptr);
+        EXPECT_GE(draw->last_frame_stats().pixels_painted,
+                  TestCharger::kFrameSize * TestCharger::kFrameSize)
+                << "frame " << i;
+        // Past the governor's interval between animation frames.
+        usleep(50 * 1000);
+    }
+    EXPECT_EQ(4, draw->frame_counters().presented);
+}
+
+// The frame after the one presented is decoded ahead of time, off the thread
+// presenting, so the next frame finds it decoded.
+TEST(AnimationFrames, NextFramePrefetched) {
+    TestCharger charger;
+    animation anim = charger.make_animation();
+    std::vector<std::unique_ptr<GRSurface>> surfaces = make_frames(3, true);
+    animation::frame frames[3] = {};
+    for (int i = 0; i < 3; i++) {
+        frames[i].max_level = 100;
+        frames[i].surface = surfaces[i].release();
+    }
+    anim.frames = frames;
+    anim.num_frames = 3;
+    anim.run = true;
+    MemoryDrawBackend* backend = new MemoryDrawBackend(charger.config(400, 700));
+    std::unique_ptr<HealthdDraw> draw =
+            HealthdDraw::Create(&anim, std::unique_ptr<HealthdDrawBackend>(backend));
+
+    for (int i = 0; i < 3; i++) {
+        anim.cur_frame = i;
+        draw->redraw_screen(&anim, nullptr);
+        usleep(50 * 1000);
+    }
+    AnimationFrameStore::Stats stats = draw->frame_store_stats();
+    EXPECT_EQ(3, draw->frame_counters().presented);
+    EXPECT_EQ(2, stats.prefetches);
+    EXPECT_EQ(1, stats.misses);
+    EXPECT_EQ(2, stats.hits);
+}
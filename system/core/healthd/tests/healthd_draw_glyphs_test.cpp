@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "healthd_draw_glyphs.h"
+
+class GlyphCacheTest : public testing::Test {
+  protected:
+    static constexpr uint32_t kCharWidth = 10;
+    static constexpr uint32_t kCharHeight = 18;
+    static constexpr uint32_t kWidth = 96 * kCharWidth;
+    static constexpr uint32_t kHeight = 2 * kCharHeight;
+
+    void SetUp() override {
+        std::string dir = testing::TempDir();
+        png_path_ = dir + "/healthd_glyphs_test.png";
+        cache_path_ = dir + "/healthd_glyphs_test.glyphs";
+        pixels_.resize(kWidth * kHeight);
+        for (size_t i = 0; i < pixels_.size(); i++) pixels_[i] = (i * 37) & 0xff;
+        write_png(png_path_, "not really a PNG, only its chunks count");
+    }
+    void TearDown() override {
+        unlink(png_path_.c_str());
+        unlink(cache_path_.c_str());
+    }
+
+    static void write_file(const std::string& path, const std::string& contents) {
+        FILE* file = fopen(path.c_str(), "we");
+        ASSERT_NE(nullptr, file);
+        fwrite(contents.data(), 1, contents.size(), file);
+        fclose(file);
+    }
+
+    static uint32_t crc32(const std::string& bytes) {
+        uint32_t crc = 0xffffffff;
+        for (unsigned char byte : bytes) {
+            crc ^= byte;
+            for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+        return ~crc;
+    }
+
+    static void append_be32(std::string* out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) out->push_back(value >> shift);
+    }
+
+    static void append_chunk(std::string* png, const char* type, const std::string& data) {
+        std::string body = std::string(type) + data;
+        append_be32(png, data.size());
+        png->append(body);
+        append_be32(png, crc32(body));
+    }
+
+    // A file laid out as a PNG, with one chunk holding |text|: only its chunks'
+    // CRCs identify it.
+    static void write_png(const std::string& path, const std::string& text) {
+        std::string png("\x89PNG\r\n\x1a\n", 8);
+        append_chunk(&png, "tEXt", text);
+        append_chunk(&png, "IEND", "");
+        write_file(path, png);
+    }
+
+    bool build_cache() {
+        GlyphCacheSource source;
+        return read_glyph_cache_source(png_path_, &source) &&
+               write_glyph_cache(cache_path_, source, kCharWidth, kCharHeight, kWidth, kHeight,
+                                 kWidth, pixels_.data());
+    }
+
+    std::unique_ptr<MappedGlyphFont> map() {
+        GlyphCacheSource source;
+        if (!read_glyph_cache_source(png_path_, &source)) return nullptr;
+        return MappedGlyphFont::Map(cache_path_, source);
+    }
+
+    std::string png_path_;
+    std::string cache_path_;
+    std::vector<uint8_t> pixels_;
+};
+
+TEST_F(GlyphCacheTest, MapsTextureInPlace) {
+    ASSERT_TRUE(build_cache());
+    std::unique_ptr<MappedGlyphFont> mapped = map();
+    ASSERT_NE(nullptr, mapped);
+    const GRFont* font = mapped->font();
+    EXPECT_EQ(static_cast<int>(kCharWidth), font->char_width);
+    EXPECT_EQ(static_cast<int>(kCharHeight), font->char_height);
+    ASSERT_EQ(kWidth, font->texture->width);
+    ASSERT_EQ(kHeight, font->texture->height);
+    const uint8_t* data = const_cast<GRSurface*>(font->texture)->data();
+    EXPECT_EQ(0, memcmp(pixels_.data(), data, pixels_.size()));
+}
+
+// A cache is ignored once its PNG changed, even to contents of the same size
+// and whatever the mtime, and cannot be checked at all without the PNG.
+TEST_F(GlyphCacheTest, RejectsCacheOfAnotherSource) {
+    ASSERT_TRUE(build_cache());
+    write_png(png_path_, "not really a PNG, only its chunks count!");
+    EXPECT_EQ(nullptr, map());
+    write_png(png_path_, "NOT really a PNG, only its chunks count");
+    EXPECT_EQ(nullptr, map());
+    write_png(png_path_, "not really a PNG, only its chunks count");
+    EXPECT_NE(nullptr, map());
+
+    GlyphCacheSource source;
+    write_file(png_path_, "not really a PNG, only its chunks count");
+    EXPECT_FALSE(read_glyph_cache_source(png_path_, &source));
+    unlink(png_path_.c_str());
+    EXPECT_FALSE(read_glyph_cache_source(png_path_, &source));
+}
+
+// The PNG's chunk CRCs are read, not its data, and a PNG cut short is refused.
+TEST_F(GlyphCacheTest, ReadsChunkCrcs) {
+    GlyphCacheSource source;
+    ASSERT_TRUE(read_glyph_cache_source(png_path_, &source));
+    std::string png;
+    ASSERT_TRUE(android::base::ReadFileToString(png_path_, &png));
+    EXPECT_EQ(static_cast<int64_t>(png.size()), source.size);
+
+    // Flipping a byte of the text without updating its CRC goes unnoticed, as
+    // it would in a PNG libpng could not read anyway.
+    png[8 + 8] ^= 1;
+    write_file(png_path_, png);
+    GlyphCacheSource flipped;
+    ASSERT_TRUE(read_glyph_cache_source(png_path_, &flipped));
+    EXPECT_EQ(source.digest, flipped.digest);
+
+    write_file(png_path_, png.substr(0, png.size() - 1));
+    EXPECT_FALSE(read_glyph_cache_source(png_path_, &flipped));
+}
+
+TEST_F(GlyphCacheTest, RejectsMalformedCache) {
+    ASSERT_TRUE(build_cache());
+    ASSERT_EQ(0, truncate(cache_path_.c_str(), sizeof(GlyphCacheHeader) + kWidth));
+    EXPECT_EQ(nullptr, map());
+    write_file(cache_path_, "short");
+    EXPECT_EQ(nullptr, map());
+}
+
+// Font names resolve as minui resolves them.
+TEST(GlyphCachePaths, FollowMinui) {
+    EXPECT_EQ("/res/images/percent.png", font_png_path("percent"));
+    EXPECT_EQ("/vendor/etc/res/percent.png", font_png_path("/vendor/etc/res/percent.png"));
+    EXPECT_EQ("/res/images/glyph_cache/percent.glyphs",
+              glyph_cache_path(kGlyphCacheDir, "percent"));
+    EXPECT_EQ("/res/images/glyph_cache/_vendor_etc_res_percent.png.glyphs",
+              glyph_cache_path(kGlyphCacheDir, "/vendor/etc/res/percent.png"));
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_GOLDEN_H
+#define HEALTHD_DRAW_GOLDEN_H
+
+#include <batteryservice/BatteryService.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "healthd_draw.h"
+#include "healthd_draw_memory.h"
+
+// Golden-image and frame-time sweep of the charger screen on a host. Renders
+// every battery level 0..100 in each status (charging, full, unknown), in each
+// rotation (NONE, RIGHT), with split-screen off and on, into a
+// MemoryDrawBackend. Each result is compared with a baseline recorded earlier:
+// the frame must match pixel for pixel, and neither it nor the whole sweep may
+// have got slower than the allowed thresholds.
+//
+// The baseline is a text file with one line per case:
+//
+//   <case name> <digest of the framebuffer, hex> <median frame time, ns>
+//
+// A digest stands in for the golden image itself, so a baseline for all 1212
+// cases stays small. The frame of every case that fails is dumped as a PPM for
+// inspection.
+class ChargerGoldenSuite {
+  public:
+    struct Case {
+        int level;
+        int status;
+        GRRotation rotation;
+        bool split;
+
+        std::string name() const {
+            char name[64];
+            snprintf(name, sizeof(name), "level%03d-status%d-%s-%s", level, status,
+                     rotation == GRRotation::RIGHT ? "right" : "none",
+                     split ? "split" : "whole");
+            return name;
+        }
+    };
+
+    struct Result {
+        uint64_t digest;
+        int64_t frame_ns;
+    };
+
+    struct Options {
+        // Frames timed per case; the median counts.
+        int repeats = 5;
+        // The sweep regresses once the sum of its frame times grows by more than
+        // this fraction of the baseline's.
+        double max_slowdown = 0.25;
+        // A single case regresses once its frame time grows by more than this
+        // fraction of the baseline, and by more than min_regression_ns, about
+        // the slowest case's frame time. Frames take about a microsecond, and a
+        // preempted run can take several times that, so single cases only catch
+        // gross regressions; the sum catches the rest.
+        double max_case_slowdown = 9.0;
+        int64_t min_regression_ns = 5000;
+        // Where the frames of failing cases are dumped; nothing is dumped if empty.
+        std::string failure_dir;
+    };
+
+    // Every HealthdDraw the suite creates draws an animation of its own from
+    // |make_animation|, as it takes the animation's frames.
+    ChargerGoldenSuite(const MemoryDrawBackend::Config& backend,
+                       std::function<animation()> make_animation, const Options& options)
+        : backend_(backend), make_animation_(std::move(make_animation)), options_(options) {}
+
+    static std::vector<Case> all_cases() {
+        std::vector<Case> cases;
+        for (bool split : {false, true}) {
+            for (GRRotation rotation : {GRRotation::NONE, GRRotation::RIGHT}) {
+                for (int status : {BATTERY_STATUS_CHARGING, BATTERY_STATUS_FULL,
+                                   BATTERY_STATUS_UNKNOWN}) {
+                    for (int level = 0; level <= 100; level++) {
+                        cases.push_back({level, status, rotation, split});
+                    }
+                }
+            }
+        }
+        return cases;
+    }
+
+    // Renders every case, keyed by name.
+    std::map<std::string, Result> run() {
+        std::map<std::string, Result> results;
+        for (const Case& c : all_cases()) results[c.name()] = render(c, nullptr);
+        return results;
+    }
+
+    static bool load_baseline(const std::string& path, std::map<std::string, Result>* baseline) {
+        FILE* file = fopen(path.c_str(), "re");
+        if (file == nullptr) return false;
+        char name[64];
+        Result result;
+        while (fscanf(file, "%63s %" SCNx64 " %" SCNd64, name, &result.digest,
+                      &result.frame_ns) == 3) {
+            (*baseline)[name] = result;
+        }
+        bool ok = !ferror(file);
+        fclose(file);
+        return ok;
+    }
+
+    static bool write_baseline(const std::string& path,
+                               const std::map<std::string, Result>& results) {
+        FILE* file = fopen(path.c_str(), "we");
+        if (file == nullptr) return false;
+        for (const auto& [name, result] : results) {
+            fprintf(file, "%s %016" PRIx64 " %" PRId64 "\n", name.c_str(), result.digest,
+                    result.frame_ns);
+        }
+        return fclose(file) == 0;
+    }
+
+    // Reports every case of |results| that differs from |baseline|, is slower
+    // than it allows, or is missing from it, to |report|, and the whole sweep if
+    // it is slower than the baseline allows. Returns how many failed.
+    int compare(const std::map<std::string, Result>& results,
+                const std::map<std::string, Result>& baseline, FILE* report) {
+        int failures = 0;
+        int64_t total_ns = 0;
+        int64_t baseline_total_ns = 0;
+        for (const Case& c : all_cases()) {
+            std::string name = c.name();
+            auto found = results.find(name);
+            auto expected = baseline.find(name);
+            if (found == results.end()) continue;
+            const Result& result = found->second;
+            const char* failure = nullptr;
+            if (expected == baseline.end()) {
+                failure = "missing from baseline";
+            } else if (result.digest != expected->second.digest) {
+                failure = "image differs";
+            } else if (result.frame_ns >
+                               expected->second.frame_ns * (1 + options_.max_case_slowdown) &&
+                       result.frame_ns - expected->second.frame_ns > options_.min_regression_ns) {
+                failure = "slower";
+            }
+            if (expected != baseline.end()) {
+                total_ns += result.frame_ns;
+                baseline_total_ns += expected->second.frame_ns;
+            }
+            if (failure == nullptr) continue;
+            failures++;
+            fprintf(report, "%s: %s (digest %016" PRIx64 ", %" PRId64 " ns; baseline %016" PRIx64
+                    ", %" PRId64 " ns)\n",
+                    name.c_str(), failure, result.digest, result.frame_ns,
+                    expected == baseline.end() ? 0 : expected->second.digest,
+                    expected == baseline.end() ? 0 : expected->second.frame_ns);
+            if (!options_.failure_dir.empty()) {
+                std::string path = options_.failure_dir + "/" + name + ".ppm";
+                render(c, path.c_str());
+            }
+        }
+        if (total_ns > baseline_total_ns * (1 + options_.max_slowdown)) {
+            failures++;
+            fprintf(report, "sweep: slower (%" PRId64 " ns; baseline %" PRId64 " ns)\n",
+                    total_ns, baseline_total_ns);
+        }
+        fprintf(report, "%d of %zu cases failed\n", failures, results.size());
+        return failures;
+    }
+
+    // FNV-1a over the visible bytes of every row.
+    static uint64_t digest(const GRSurface* surface) {
+        uint64_t hash = 1469598103934665603ull;
+        for (size_t y = 0; y < surface->height; y++) {
+            const uint8_t* row = surface->data() + y * surface->row_bytes;
+            for (size_t i = 0; i < surface->width * surface->pixel_bytes; i++) {
+                hash = (hash ^ row[i]) * 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+  private:
+    // Renders |c| and returns its digest and median frame time; dumps the frame
+    // to |ppm_path| if set.
+    Result render(const Case& c, const char* ppm_path) {
+        Instance& instance = instance_for(c);
+        HealthdDraw* draw = instance.draw.get();
+        animation* anim = &instance.anim;
+        // rotate_screen() picks landscape for connector 0 and portrait otherwise.
+        draw->rotate_screen(c.rotation == GRRotation::RIGHT ? 0 : 1);
+
+        // Each timed frame follows one at a neighboring level, so it is drawn the
+        // way the charger draws a level change.
+        std::vector<int64_t> times;
+        for (int i = 0; i < std::max(options_.repeats, 1); i++) {
+            anim->cur_status = c.status;
+            anim->cur_level = c.level == 100 ? 99 : c.level + 1;
+            draw->redraw_screen(anim, nullptr);
+            anim->cur_level = c.level;
+            auto start = std::chrono::steady_clock::now();
+            draw->redraw_screen(anim, nullptr);
+            times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count());
+        }
+        std::sort(times.begin(), times.end());
+        if (ppm_path != nullptr) instance.backend->dump_ppm(ppm_path);
+        return {digest(instance.backend->front()), times[times.size() / 2]};
+    }
+
+    // One HealthdDraw per split-screen setting, which is fixed at creation;
+    // rotation, status and level are switched between cases.
+    struct Instance {
+        animation anim;
+        MemoryDrawBackend* backend = nullptr;
+        std::unique_ptr<HealthdDraw> draw;
+    };
+
+    Instance& instance_for(const Case& c) {
+        Instance& instance = instances_[c.split];
+        if (instance.draw) return instance;
+        MemoryDrawBackend::Config config = backend_;
+        config.split_screen = c.split;
+        if (!c.split) config.split_offset = 0;
+        instance.anim = make_animation_();
+        instance.backend = new MemoryDrawBackend(config);
+        instance.draw = HealthdDraw::Create(&instance.anim,
+                                            std::unique_ptr<HealthdDrawBackend>(instance.backend));
+        return instance;
+    }
+
+    MemoryDrawBackend::Config backend_;
+    std::function<animation()> make_animation_;
+    Options options_;
+    Instance instances_[2];
+};
+
+#endif  // HEALTHD_DRAW_GOLDEN_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <batteryservice/BatteryService.h>
+#include <gtest/gtest.h>
+
+#include "healthd_draw_governor.h"
+
+// What the charger shows at |level|, charging, 25.0 degrees Celsius.
+static FrameGovernor::Inputs charging(int level, bool animating) {
+    FrameGovernor::Inputs in = {};
+    in.animating = animating;
+    in.level = level;
+    in.status = BATTERY_STATUS_CHARGING;
+    in.temperature = 250;
+    return in;
+}
+
+// Offers |in| every 10 ms for |duration_ms| from |*now_ms|, as the charger's
+// event loop would; returns how many frames were let through.
+static int run(FrameGovernor* governor, const FrameGovernor::Inputs& in, int64_t* now_ms,
+               int64_t duration_ms) {
+    int admitted = 0;
+    for (int64_t end = *now_ms + duration_ms; *now_ms < end; *now_ms += 10) {
+        if (governor->admit(in, *now_ms)) admitted++;
+    }
+    return admitted;
+}
+
+// A battery animation keeps advancing at full rate at a throttled level,
+// temperature or status, long after the last visible change.
+TEST(FrameGovernor, AnimationRunsAtFullRateWhileThrottled) {
+    FrameGovernor::Config config;
+    FrameGovernor::Inputs low = charging(config.throttle_level, true);
+    FrameGovernor::Inputs hot = charging(50, true);
+    hot.temperature = config.throttle_temperature;
+    FrameGovernor::Inputs full = charging(100, true);
+    full.full = true;
+    for (const FrameGovernor::Inputs& in : {low, hot, full}) {
+        FrameGovernor governor(config);
+        int64_t now_ms = 0;
+        run(&governor, in, &now_ms, 10 * config.settle_ms);
+        int frames = run(&governor, in, &now_ms, 10000);
+        // One frame per active interval, rounded up to the 10 ms the loop polls at.
+        EXPECT_GE(frames, 10000 / 40) << "level " << in.level;
+        FrameGovernor::Stats stats = governor.stats(now_ms);
+        EXPECT_EQ(FrameGovernor::MODE_ACTIVE, stats.mode) << "level " << in.level;
+        EXPECT_EQ(config.active_interval_ms, stats.interval_ms) << "level " << in.level;
+    }
+}
+
+// Once the animation stops, the same screen slows down past the steady rate.
+TEST(FrameGovernor, SteadyScreenIsThrottled) {
+    FrameGovernor::Config config;
+    FrameGovernor governor(config);
+    int64_t now_ms = 0;
+    run(&governor, charging(3, true), &now_ms, 1000);
+    FrameGovernor::Inputs still = charging(3, false);
+    run(&governor, still, &now_ms, config.settle_ms);
+    int frames = run(&governor, still, &now_ms, 4 * config.throttled_interval_ms);
+    EXPECT_LE(frames, 4);
+    FrameGovernor::Stats stats = governor.stats(now_ms);
+    EXPECT_EQ(FrameGovernor::MODE_THROTTLED, stats.mode);
+    EXPECT_EQ(FrameGovernor::REASON_LOW_LEVEL, stats.reason);
+
+    // A level change is still drawn at once.
+    EXPECT_TRUE(governor.admit(charging(4, false), now_ms));
+}
+
+TEST(FrameGovernor, SteadyScreenAtSteadyRate) {
+    FrameGovernor::Config config;
+    FrameGovernor governor(config);
+    int64_t now_ms = 0;
+    FrameGovernor::Inputs still = charging(50, false);
+    run(&governor, still, &now_ms, config.settle_ms);
+    int frames = run(&governor, still, &now_ms, 4 * config.steady_interval_ms);
+    EXPECT_LE(frames, 4);
+    EXPECT_GE(frames, 3);
+    EXPECT_EQ(FrameGovernor::MODE_STEADY, governor.stats(now_ms).mode);
+}
+
+TEST(FrameGovernor, StopsWhileBlanked) {
+    FrameGovernor governor;
+    int64_t now_ms = 0;
+    FrameGovernor::Inputs in = charging(50, true);
+    run(&governor, in, &now_ms, 1000);
+    in.blanked = true;
+    EXPECT_EQ(0, run(&governor, in, &now_ms, 1000));
+    EXPECT_EQ(-1, governor.next_frame_ms(now_ms));
+    in.blanked = false;
+    EXPECT_TRUE(governor.admit(in, now_ms));
+}
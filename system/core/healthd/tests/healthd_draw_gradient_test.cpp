@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "healthd_draw_gradient.h"
+
+// The color draw_percent() computed for |level| before the table, as it was.
+static void original_percent_color(int cur_level, int* out_r, int* out_g, int* out_b) {
+    struct ColorPoint {
+        int level;
+        int r;
+        int g;
+        int b;
+    };
+    static const ColorPoint colors[] = {
+            {0, 255, 0, 0},     {15, 255, 69, 0},  {30, 255, 140, 0},
+            {45, 255, 165, 0},  {50, 255, 255, 0}, {65, 178, 255, 0},
+            {75, 127, 255, 0},  {85, 76, 255, 0},  {100, 0, 255, 0},
+    };
+    int r = 0, g = 0, b = 0;
+    for (int i = 0; i < 8; i++) {
+        if (cur_level >= colors[i].level && cur_level <= colors[i + 1].level) {
+            float t = float(cur_level - colors[i].level) /
+                      float(colors[i + 1].level - colors[i].level);
+            r = colors[i].r + (int)((colors[i + 1].r - colors[i].r) * t);
+            g = colors[i].g + (int)((colors[i + 1].g - colors[i].g) * t);
+            b = colors[i].b + (int)((colors[i + 1].b - colors[i].b) * t);
+            break;
+        }
+    }
+    *out_r = r;
+    *out_g = g;
+    *out_b = b;
+}
+
+// The same float interpolation over any stops.
+static GradientColor float_color(const std::vector<GradientStop>& stops, int level) {
+    for (size_t i = 0; i + 1 < stops.size(); i++) {
+        if (level < stops[i].level || level > stops[i + 1].level) continue;
+        float t = float(level - stops[i].level) / float(stops[i + 1].level - stops[i].level);
+        return {static_cast<uint8_t>(stops[i].r + (int)((stops[i + 1].r - stops[i].r) * t)),
+                static_cast<uint8_t>(stops[i].g + (int)((stops[i + 1].g - stops[i].g) * t)),
+                static_cast<uint8_t>(stops[i].b + (int)((stops[i + 1].b - stops[i].b) * t)), 255};
+    }
+    return {0, 0, 0, 0};
+}
+
+TEST(GradientLut, DefaultTableMatchesPerFrameFloatLoop) {
+    for (int level = 0; level < GradientLut::kLevels; level++) {
+        int r, g, b;
+        original_percent_color(level, &r, &g, &b);
+        const GradientColor& color = kDefaultGradientLut.at(level);
+        EXPECT_EQ(r, color.r) << "level " << level;
+        EXPECT_EQ(g, color.g) << "level " << level;
+        EXPECT_EQ(b, color.b) << "level " << level;
+        EXPECT_EQ(255, color.a) << "level " << level;
+    }
+}
+
+// Ramps loaded from the screen description are baked at startup by the same
+// code; random ones must come out as the float interpolation would draw them.
+TEST(GradientLut, CustomRampsBakeFloatInterpolation) {
+    std::mt19937 rng(1);
+    for (int iteration = 0; iteration < 20000; iteration++) {
+        std::vector<int> levels = {0, 100};
+        for (int i = rng() % 8; i > 0; i--) levels.push_back(1 + rng() % 99);
+        std::sort(levels.begin(), levels.end());
+        levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+        std::vector<GradientStop> stops;
+        for (int level : levels) {
+            stops.push_back({level, static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()),
+                             static_cast<uint8_t>(rng())});
+        }
+        ASSERT_TRUE(gradient_stops_valid(stops.data(), stops.size()));
+        GradientLut lut = make_gradient_lut(stops.data(), stops.size());
+        ASSERT_TRUE(gradient_lut_complete(lut));
+        for (int level = 0; level < GradientLut::kLevels; level++) {
+            GradientColor expected = float_color(stops, level);
+            const GradientColor& color = lut.at(level);
+            ASSERT_TRUE(expected.r == color.r && expected.g == color.g && expected.b == color.b &&
+                        expected.a == color.a)
+                    << "ramp " << iteration << ", level " << level;
+        }
+    }
+}
+
+TEST(GradientLut, RejectsRampsNotSpanningEveryLevel) {
+    const GradientStop from_1[] = {{1, 0, 0, 0}, {100, 255, 255, 255}};
+    const GradientStop to_99[] = {{0, 0, 0, 0}, {99, 255, 255, 255}};
+    const GradientStop repeated[] = {{0, 0, 0, 0}, {50, 1, 1, 1}, {50, 2, 2, 2}, {100, 0, 0, 0}};
+    const GradientStop decreasing[] = {{0, 0, 0, 0}, {60, 1, 1, 1}, {40, 2, 2, 2}, {100, 0, 0, 0}};
+    const GradientStop single[] = {{0, 0, 0, 0}};
+    EXPECT_FALSE(gradient_stops_valid(from_1, 2));
+    EXPECT_FALSE(gradient_stops_valid(to_99, 2));
+    EXPECT_FALSE(gradient_stops_valid(repeated, 4));
+    EXPECT_FALSE(gradient_stops_valid(decreasing, 4));
+    EXPECT_FALSE(gradient_stops_valid(single, 1));
+    EXPECT_FALSE(gradient_lut_complete(make_gradient_lut(from_1, 2)));
+    EXPECT_FALSE(gradient_lut_complete(make_gradient_lut(to_99, 2)));
+}
+
+TEST(GradientLut, ClampsLevelsOutOfRange) {
+    EXPECT_EQ(&kDefaultGradientLut.colors[0], &kDefaultGradientLut.at(-5));
+    EXPECT_EQ(&kDefaultGradientLut.colors[100], &kDefaultGradientLut.at(101));
+    EXPECT_EQ(&kDefaultGradientLut.colors[100], &kDefaultGradientLut.at(250));
+}
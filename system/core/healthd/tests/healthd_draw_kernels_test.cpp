@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "healthd_draw_kernels.h"
+
+// The vector kernel sets this build and CPU can run.
+static std::vector<const RasterKernels*> vector_kernels() {
+    std::vector<const RasterKernels*> kernels;
+#if defined(HEALTHD_KERNELS_X86) && defined(__SSE2__)
+    kernels.push_back(&kSse2RasterKernels);
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(&kAvx2RasterKernels);
+#elif defined(HEALTHD_KERNELS_NEON)
+    kernels.push_back(&kNeonRasterKernels);
+#endif
+    return kernels;
+}
+
+class RasterKernelsTest : public testing::TestWithParam<const RasterKernels*> {};
+
+// Random spans of every length up to several vectors and a tail, at every
+// alignment, with coverage mixing none, full and partial, against the scalar
+// blend. Opaque and translucent colors both.
+TEST_P(RasterKernelsTest, BlendMaskMatchesScalar) {
+    const RasterKernels& kernels = *GetParam();
+    std::mt19937 rng(1);
+    for (int iteration = 0; iteration < 20000; iteration++) {
+        int count = rng() % 70;
+        int offset = rng() % 8;
+        std::vector<uint32_t> pixels(offset + count);
+        std::vector<uint8_t> mask(offset + count);
+        for (uint32_t& pixel : pixels) pixel = rng();
+        for (uint8_t& coverage : mask) {
+            int kind = rng() % 4;
+            coverage = kind == 0 ? 0 : kind == 1 ? 255 : rng();
+        }
+        uint32_t color = rng();
+        if (iteration % 3 == 0) color |= 0xff000000u;
+
+        std::vector<uint32_t> expected = pixels;
+        raster_blend_mask_scalar(expected.data() + offset, mask.data() + offset, count, color);
+        kernels.blend_mask(pixels.data() + offset, mask.data() + offset, count, color);
+        ASSERT_EQ(expected, pixels) << kernels.name << ": " << count << " pixels at offset "
+                                    << offset << ", color " << std::hex << color;
+    }
+}
+
+TEST_P(RasterKernelsTest, FillMatchesScalar) {
+    const RasterKernels& kernels = *GetParam();
+    std::mt19937 rng(2);
+    for (int iteration = 0; iteration < 2000; iteration++) {
+        int count = rng() % 70;
+        int offset = rng() % 8;
+        uint32_t color = rng();
+        std::vector<uint32_t> pixels(offset + count + 8, 0x12345678);
+        std::vector<uint32_t> expected = pixels;
+        raster_fill_scalar(expected.data() + offset, count, color);
+        kernels.fill(pixels.data() + offset, count, color);
+        ASSERT_EQ(expected, pixels) << kernels.name << ": " << count << " pixels at offset "
+                                    << offset;
+    }
+}
+
+// Every blend of every coverage and alpha over a few backgrounds, exhaustively.
+TEST_P(RasterKernelsTest, BlendMaskIsExactForEveryCoverageAndAlpha) {
+    const RasterKernels& kernels = *GetParam();
+    std::vector<uint8_t> mask(256);
+    for (int i = 0; i < 256; i++) mask[i] = i;
+    for (uint32_t background : {0x00000000u, 0xffffffffu, 0x80402010u, 0xff7f00c3u}) {
+        for (int alpha = 0; alpha < 256; alpha++) {
+            uint32_t color = static_cast<uint32_t>(alpha) << 24 | 0x00c08040u;
+            std::vector<uint32_t> expected(256, background);
+            std::vector<uint32_t> pixels(256, background);
+            raster_blend_mask_scalar(expected.data(), mask.data(), 256, color);
+            kernels.blend_mask(pixels.data(), mask.data(), 256, color);
+            ASSERT_EQ(expected, pixels) << kernels.name << ": alpha " << alpha;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Vector, RasterKernelsTest, testing::ValuesIn(vector_kernels()),
+                         [](const testing::TestParamInfo<const RasterKernels*>& info) {
+                             return std::string(info.param->name);
+                         });
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(RasterKernelsTest);
+
+// The kernels picked are among those tested, or the scalar ones.
+TEST(RasterKernels, DispatchPicksWidestSupported) {
+    std::vector<const RasterKernels*> kernels = vector_kernels();
+    const RasterKernels* widest = kernels.empty() ? &kScalarRasterKernels : kernels.back();
+    EXPECT_STREQ(widest->name, raster_kernels().name);
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "healthd_draw_rate.h"
+
+static constexpr int64_t kMinuteMs = 60 * 1000;
+
+// Feeds a battery charging at |rate| percent per hour from |from| to |to|, one
+// call per second as frames would, starting at |*now_ms|.
+static void charge(ChargeRateEstimator* estimator, int64_t* now_ms, double rate, int from,
+                   int to) {
+    const int64_t start_ms = *now_ms;
+    for (int level = from; level < to; (*now_ms) += 1000) {
+        level = from + static_cast<int>(rate * (*now_ms - start_ms) / (60 * kMinuteMs));
+        estimator->add(*now_ms, std::min(level, to), BATTERY_STATUS_CHARGING);
+    }
+}
+
+// The slope in percent per hour of the least-squares line through the steps in
+// the window, computed from scratch.
+static double batch_regression_rate(const ChargeRateEstimator& estimator) {
+    int n = estimator.sample_count();
+    double t0 = estimator.sample(0).time_ms;
+    double st = 0, sl = 0, stt = 0, stl = 0;
+    for (int i = 0; i < n; i++) {
+        double t = estimator.sample(i).time_ms - t0;
+        double l = estimator.sample(i).level;
+        st += t;
+        sl += l;
+        stt += t * t;
+        stl += t * l;
+    }
+    return (n * stl - st * sl) / (n * stt - st * st) * 60 * kMinuteMs;
+}
+
+TEST(ChargeRateEstimator, ConstantRate) {
+    ChargeRateEstimator estimator;
+    int64_t now_ms = 0;
+    // 30%/h is one step every two minutes.
+    charge(&estimator, &now_ms, 30, 20, 50);
+    const ChargeRateEstimator::Estimate& estimate = estimator.estimate();
+    ASSERT_TRUE(estimate.valid);
+    EXPECT_NEAR(30, estimate.rate, 0.5);
+    EXPECT_NEAR(30, estimate.ewma_rate, 0.5);
+    // 50% to go at 30%/h is 100 minutes, already a multiple of 5.
+    EXPECT_EQ(100, estimate.minutes_to_full);
+    EXPECT_STREQ(" 30%/h  1h40", estimator.text().text);
+    EXPECT_EQ(ChargeRateEstimator::kTextLength, estimator.text().length);
+}
+
+// Steps only stay in the regression for the window, so a rate change is
+// followed once the old steps have left it.
+TEST(ChargeRateEstimator, FollowsRateChange) {
+    ChargeRateEstimator::Config config;
+    config.window_ms = 30 * kMinuteMs;
+    ChargeRateEstimator estimator(config);
+    int64_t now_ms = 0;
+    charge(&estimator, &now_ms, 60, 10, 60);
+    EXPECT_NEAR(60, estimator.estimate().rate, 1);
+    charge(&estimator, &now_ms, 15, 60, 75);
+    ASSERT_GE(estimator.sample_count(), config.min_regression_samples);
+    EXPECT_NEAR(15, estimator.estimate().regression_rate, 0.5);
+    EXPECT_NEAR(15, estimator.estimate().ewma_rate, 1);
+    EXPECT_EQ(estimator.estimate().regression_rate, estimator.estimate().rate);
+    for (int i = 0; i < estimator.sample_count(); i++) {
+        EXPECT_LE(now_ms - estimator.sample(i).time_ms, config.window_ms + 1000);
+    }
+}
+
+// A noisy curve slowing down towards full over a whole night: the running
+// sums, rebased over and over, keep agreeing with the regression computed from
+// scratch, and the ring never holds more than kCapacity steps.
+TEST(ChargeRateEstimator, RunningSumsMatchBatchRegression) {
+    ChargeRateEstimator::Config config;
+    config.window_ms = 60 * kMinuteMs;
+    ChargeRateEstimator estimator(config);
+    std::mt19937 rng(1);
+    int64_t now_ms = 0;
+    int checked = 0;
+    for (int night = 0; night < 4; night++) {
+        for (int level = 1; level <= 100; level++) {
+            // From 2 to 40 minutes a step, jittered by up to a minute.
+            now_ms += (2 + level * level / 256) * kMinuteMs + rng() % kMinuteMs;
+            estimator.add(now_ms, level, BATTERY_STATUS_CHARGING);
+            ASSERT_LE(estimator.sample_count(), ChargeRateEstimator::kCapacity);
+            if (estimator.sample_count() < 2) continue;
+            ASSERT_NEAR(batch_regression_rate(estimator), estimator.estimate().regression_rate,
+                        1e-6)
+                    << "night " << night << ", level " << level;
+            checked++;
+        }
+        // Unplugged in the morning, plugged back in at 1% in the evening.
+        estimator.add(now_ms, 100, BATTERY_STATUS_FULL);
+        now_ms += 12 * 60 * kMinuteMs;
+        estimator.add(now_ms, 0, BATTERY_STATUS_CHARGING);
+    }
+    EXPECT_GT(checked, 300);
+}
+
+TEST(ChargeRateEstimator, NothingShownBeforeMinSpan) {
+    ChargeRateEstimator estimator;
+    int64_t now_ms = 0;
+    estimator.add(now_ms, 40, BATTERY_STATUS_CHARGING);
+    // The first step starts the span, the second gives a rate.
+    estimator.add(now_ms += kMinuteMs, 41, BATTERY_STATUS_CHARGING);
+    estimator.add(now_ms += kMinuteMs, 42, BATTERY_STATUS_CHARGING);
+    EXPECT_FALSE(estimator.estimate().valid);
+    EXPECT_EQ(0u, estimator.text().length);
+    estimator.add(now_ms += 2 * kMinuteMs, 43, BATTERY_STATUS_CHARGING);
+    EXPECT_TRUE(estimator.estimate().valid);
+    EXPECT_NE(0u, estimator.text().length);
+}
+
+TEST(ChargeRateEstimator, GoesStaleWithoutSteps) {
+    ChargeRateEstimator estimator;
+    int64_t now_ms = 0;
+    charge(&estimator, &now_ms, 30, 20, 30);
+    ASSERT_TRUE(estimator.estimate().valid);
+    EXPECT_FALSE(estimator.add(now_ms += 29 * kMinuteMs, 30, BATTERY_STATUS_CHARGING));
+    EXPECT_TRUE(estimator.estimate().valid);
+    EXPECT_TRUE(estimator.add(now_ms += 2 * kMinuteMs, 30, BATTERY_STATUS_CHARGING));
+    EXPECT_FALSE(estimator.estimate().valid);
+    EXPECT_EQ(0u, estimator.text().length);
+}
+
+// Discharging, a level going down or time going back all start over.
+TEST(ChargeRateEstimator, Restarts) {
+    ChargeRateEstimator estimator;
+    int64_t now_ms = 0;
+    charge(&estimator, &now_ms, 30, 20, 30);
+    ASSERT_TRUE(estimator.estimate().valid);
+    EXPECT_TRUE(estimator.add(now_ms, 30, BATTERY_STATUS_DISCHARGING));
+    EXPECT_FALSE(estimator.estimate().valid);
+    EXPECT_EQ(0, estimator.sample_count());
+
+    charge(&estimator, &now_ms, 30, 30, 40);
+    ASSERT_TRUE(estimator.estimate().valid);
+    estimator.add(now_ms, 39, BATTERY_STATUS_CHARGING);
+    EXPECT_FALSE(estimator.estimate().valid);
+
+    charge(&estimator, &now_ms, 30, 39, 49);
+    ASSERT_TRUE(estimator.estimate().valid);
+    estimator.add(now_ms - 10 * kMinuteMs, 49, BATTERY_STATUS_CHARGING);
+    EXPECT_FALSE(estimator.estimate().valid);
+}
+
+// Rates outside the shown range leave the text empty.
+TEST(ChargeRateEstimator, RejectsImplausibleRates) {
+    ChargeRateEstimator estimator;
+    int64_t now_ms = 0;
+    charge(&estimator, &now_ms, 0.4, 20, 22);
+    EXPECT_FALSE(estimator.estimate().valid);
+    EXPECT_NEAR(0.4, estimator.estimate().rate, 0.1);
+}
+
+// The text is only reformatted, and its generation only moves, when the
+// rounded estimate changes: a few times over an hour at a steady rate, not
+// at every frame or step.
+TEST(ChargeRateEstimator, TextChangesOnlyWithRoundedEstimate) {
+    ChargeRateEstimator estimator;
+    int64_t now_ms = 0;
+    int changes = 0;
+    uint64_t generation = estimator.text().generation;
+    for (int level = 20; level < 50; now_ms += 1000) {
+        level = 20 + static_cast<int>(now_ms / (2 * kMinuteMs));
+        bool changed = estimator.add(now_ms, level, BATTERY_STATUS_CHARGING);
+        EXPECT_EQ(changed, estimator.text().generation != generation);
+        generation = estimator.text().generation;
+        changes += changed;
+    }
+    // Once per 5-minute step of the time to full, plus the first appearance
+    // and the estimate settling.
+    EXPECT_GT(changes, 5);
+    EXPECT_LT(changes, 20);
+}
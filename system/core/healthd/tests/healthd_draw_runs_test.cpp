@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <memory>
+
+#include "healthd_draw_test_utils.h"
+
+// A font measured as if proportional: '1' narrower than its cell, the rest
+// |extra| pixels wider in all.
+struct ProportionalMeasure {
+    int extra = 0;
+    int calls = 0;
+
+    static int measure(void* context, const GRFont* font, const char* str) {
+        ProportionalMeasure* self = static_cast<ProportionalMeasure*>(context);
+        self->calls++;
+        int width = self->extra;
+        for (; *str; str++) width += *str == '1' ? font->char_width / 2 : font->char_width;
+        return width;
+    }
+};
+
+TEST(GlyphRunCache, MeasuresEachRunOnce) {
+    TestCharger charger;
+    ProportionalMeasure measure;
+    GlyphRunCache cache;
+    cache.set_measure(&ProportionalMeasure::measure, &measure);
+    cache.reserve(64 * TestCharger::kCharHeight);
+
+    cache.begin_frame();
+    const GlyphRun* run = cache.get(charger.font(), "12%");
+    ASSERT_NE(nullptr, run);
+    EXPECT_EQ(TestCharger::kCharWidth / 2 + 2 * TestCharger::kCharWidth, run->width);
+    EXPECT_EQ(static_cast<size_t>(run->width), run->mask->width);
+    for (int frame = 0; frame < 10; frame++) {
+        cache.begin_frame();
+        EXPECT_EQ(run, cache.get(charger.font(), "12%"));
+    }
+    EXPECT_EQ(1, measure.calls);
+    EXPECT_EQ(10u, cache.stats().hits);
+    EXPECT_EQ(1u, cache.stats().misses);
+}
+
+// A run measured wider than its glyphs is blank past them.
+TEST(GlyphRunCache, BlankPastTheGlyphs) {
+    TestCharger charger;
+    ProportionalMeasure measure;
+    measure.extra = 7;
+    GlyphRunCache cache;
+    cache.set_measure(&ProportionalMeasure::measure, &measure);
+    cache.reserve(64 * TestCharger::kCharHeight);
+    cache.begin_frame();
+    const GlyphRun* run = cache.get(charger.font(), "50");
+    ASSERT_NE(nullptr, run);
+    ASSERT_EQ(2 * TestCharger::kCharWidth + 7, run->width);
+    const GRSurface* mask = run->mask;
+    const GRSurface* texture = charger.font()->texture;
+    for (int y = 0; y < TestCharger::kCharHeight; y++) {
+        const uint8_t* row = const_cast<GRSurface*>(mask)->data() + y * mask->row_bytes;
+        const uint8_t* glyph = const_cast<GRSurface*>(texture)->data() + y * texture->row_bytes +
+                               ('5' - ' ') * TestCharger::kCharWidth;
+        EXPECT_EQ(0, memcmp(glyph, row, TestCharger::kCharWidth)) << "row " << y;
+        for (int x = 2 * TestCharger::kCharWidth; x < run->width; x++) {
+            EXPECT_EQ(0, row[x]) << "row " << y << ", column " << x;
+        }
+    }
+}
+
+TEST(GlyphRunCache, NothingCachedWithoutMeasure) {
+    TestCharger charger;
+    GlyphRunCache cache;
+    cache.reserve(64 * TestCharger::kCharHeight);
+    cache.begin_frame();
+    EXPECT_EQ(nullptr, cache.get(charger.font(), "50%"));
+    EXPECT_EQ(1u, cache.stats().bypassed);
+}
+
+// Counts the texts HealthdDraw measures.
+class CountingBackend : public MemoryDrawBackend {
+  public:
+    using MemoryDrawBackend::MemoryDrawBackend;
+    int measure(const GRFont* font, const char* str) override {
+        measured++;
+        return MemoryDrawBackend::measure(font, str);
+    }
+    int measured = 0;
+};
+
+// Texts are measured when laid out and when their run is made, not per frame.
+TEST(GlyphRunCache, FramesDoNotMeasure) {
+    TestCharger charger;
+    animation anim = charger.make_animation();
+    CountingBackend* backend = new CountingBackend(charger.config(400, 700));
+    std::unique_ptr<HealthdDraw> draw =
+            HealthdDraw::Create(&anim, std::unique_ptr<HealthdDrawBackend>(backend));
+    for (int level : {40, 41}) {
+        anim.cur_level = level;
+        draw->redraw_screen(&anim, nullptr);
+    }
+    int measured = backend->measured;
+    int64_t presented = draw->frame_counters().presented;
+    for (int i = 0; i < 100; i++) {
+        anim.cur_level = 40 + i % 2;
+        draw->redraw_screen(&anim, nullptr);
+    }
+    EXPECT_EQ(presented + 100, draw->frame_counters().presented);
+    EXPECT_EQ(measured, backend->measured);
+}
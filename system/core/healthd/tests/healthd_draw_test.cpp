@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "healthd_draw_golden.h"
+#include "healthd_draw_test_utils.h"
+
+// Every battery level, status, rotation and split-screen setting of a 400x700
+// panel, against testdata/golden_baseline.txt. To accept new frames on purpose,
+// run the test with HEALTHD_DRAW_GOLDEN_RECORD set to the baseline to rewrite;
+// HEALTHD_DRAW_GOLDEN_FAILURES names a directory for the frames that differ.
+TEST(HealthdDrawGolden, MatchesBaseline) {
+    TestCharger charger;
+    MemoryDrawBackend::Config config = charger.config(400, 700);
+    config.split_offset = 10;
+    ChargerGoldenSuite::Options options;
+    if (const char* dir = getenv("HEALTHD_DRAW_GOLDEN_FAILURES")) options.failure_dir = dir;
+    ChargerGoldenSuite suite(config, [&charger] { return charger.make_animation(); }, options);
+
+    std::map<std::string, ChargerGoldenSuite::Result> results = suite.run();
+    if (const char* path = getenv("HEALTHD_DRAW_GOLDEN_RECORD")) {
+        ASSERT_TRUE(ChargerGoldenSuite::write_baseline(path, results));
+        GTEST_SKIP() << "baseline recorded to " << path;
+    }
+    std::map<std::string, ChargerGoldenSuite::Result> baseline;
+    ASSERT_TRUE(ChargerGoldenSuite::load_baseline(test_data_path("golden_baseline.txt"),
+                                                  &baseline));
+    EXPECT_EQ(ChargerGoldenSuite::all_cases().size(), baseline.size());
+    EXPECT_EQ(0, suite.compare(results, baseline, stdout));
+}
+
+// Digests of the frames a 600x800 panel composed on |threads| threads shows
+// through a sequence alternating whole-screen changes with level steps.
+static std::vector<uint64_t> draw_sequence(int threads) {
+    TestCharger charger;
+    MemoryDrawBackend::Config config = charger.config(600, 800);
+    config.render_threads = threads;
+    animation anim = charger.make_animation();
+    MemoryDrawBackend* backend = new MemoryDrawBackend(config);
+    std::unique_ptr<HealthdDraw> draw =
+            HealthdDraw::Create(&anim, std::unique_ptr<HealthdDrawBackend>(backend));
+    std::vector<uint64_t> digests;
+    int max_bands = 0;
+    for (int i = 0; i < 12; i++) {
+        anim.cur_status = i % 4 == 3 ? BATTERY_STATUS_UNKNOWN : BATTERY_STATUS_CHARGING;
+        anim.cur_level = 40 + i;
+        draw->redraw_screen(&anim, nullptr);
+        digests.push_back(ChargerGoldenSuite::digest(backend->front()));
+        max_bands = std::max(max_bands, draw->last_frame_stats().bands);
+    }
+    // Whole-screen changes are composed in bands once there are threads to share them.
+    EXPECT_EQ(threads > 1, max_bands > 1);
+    return digests;
+}
+
+// Composing in bands on several threads draws what one thread draws.
+TEST(HealthdDrawTiles, ThreadsDrawTheSameFrames) {
+    std::vector<uint64_t> expected = draw_sequence(1);
+    for (int threads = 2; threads <= 4; threads++) {
+        EXPECT_EQ(expected, draw_sequence(threads)) << threads << " threads";
+    }
+}
+
+// On a full HD+ panel, once both framebuffers hold a frame, a frame where only
+// the level changed writes orders of magnitude fewer framebuffer bytes than one drawing the whole screen, both as
+// HealthdDraw counts them and as the panel sees them.
+TEST(HealthdDrawDamage, LevelFramesWriteFarLessThanFullFrames) {
+    TestCharger charger;
+    MemoryDrawBackend::Config config = charger.config(1080, 2400);
+    animation anim = charger.make_animation();
+    MemoryDrawBackend* backend = new MemoryDrawBackend(config);
+    std::unique_ptr<HealthdDraw> draw =
+            HealthdDraw::Create(&anim, std::unique_ptr<HealthdDrawBackend>(backend));
+
+    anim.cur_level = 10;
+    draw->redraw_screen(&anim, nullptr);
+    ASSERT_TRUE(draw->last_frame_stats().full_redraw);
+    const int64_t full_bytes = draw->last_frame_stats().bytes_written;
+    const int64_t full_pixels = backend->last_frame().pixels_written;
+    EXPECT_GE(full_pixels, int64_t{1080} * 2400);
+    // The back buffer has never been drawn, so its first frame is copied whole.
+    anim.cur_level = 11;
+    draw->redraw_screen(&anim, nullptr);
+
+    int64_t level_bytes = 0, level_pixels = 0;
+    for (int level = 12; level < 100; level++) {
+        anim.cur_level = level;
+        draw->redraw_screen(&anim, nullptr);
+        EXPECT_FALSE(draw->last_frame_stats().full_redraw) << "level " << level;
+        level_bytes = std::max(level_bytes, draw->last_frame_stats().bytes_written);
+        level_pixels = std::max(level_pixels, backend->last_frame().pixels_written);
+    }
+    EXPECT_GT(level_bytes, 0);
+    EXPECT_GT(level_pixels, 0);
+    EXPECT_GE(full_bytes, 1000 * level_bytes);
+    EXPECT_GE(full_pixels, 1000 * level_pixels);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEALTHD_DRAW_TEST_UTILS_H
+#define HEALTHD_DRAW_TEST_UTILS_H
+
+#include <android-base/file.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "healthd_draw.h"
+#include "healthd_draw_memory.h"
+
+// The charger screen the host tests and benchmarks draw: a font whose glyphs
+// are a fixed byte pattern, used for the percent and clock texts, and a battery
+// animation of one flat gray frame. The font is shared by every
+// make_animation(); each animation gets frames of its own, since HealthdDraw
+// takes the frame surfaces it is created with, so any number of HealthdDraw
+// instances can be created from it.
+class TestCharger {
+  public:
+    static constexpr int kCharWidth = 10;
+    static constexpr int kCharHeight = 18;
+    static constexpr int kFrameSize = 64;
+
+    TestCharger() {
+        // One glyph per printable ASCII character, side by side.
+        texture_ = GRSurface::Create(95 * kCharWidth, kCharHeight, 95 * kCharWidth, 1);
+        for (size_t i = 0; i < texture_->row_bytes * texture_->height; i++) {
+            texture_->data()[i] = (i * 37) & 0xff;
+        }
+        font_ = {texture_.get(), kCharWidth, kCharHeight};
+    }
+
+    // Frees the frame surfaces no HealthdDraw took.
+    ~TestCharger() {
+        for (const std::unique_ptr<animation::frame>& frame : frames_) {
+            res_free_surface(frame->surface);
+        }
+    }
+
+    GRFont* font() { return &font_; }
+
+    // A MemoryDrawBackend panel of |width| x |height| using the font.
+    MemoryDrawBackend::Config config(int width, int height) {
+        MemoryDrawBackend::Config config;
+        config.width = width;
+        config.height = height;
+        config.font = &font_;
+        config.sys_font = &font_;
+        return config;
+    }
+
+    // A fresh animation, charging at 50%, with a frame of its own.
+    animation make_animation() {
+        frames_.push_back(std::make_unique<animation::frame>());
+        animation::frame* frame = frames_.back().get();
+        frame->max_level = 100;
+        frame->surface =
+                GRSurface::Create(kFrameSize, kFrameSize, kFrameSize * 4, sizeof(uint32_t))
+                        .release();
+        memset(frame->surface->data(), 0x80, frame->surface->row_bytes * kFrameSize);
+
+        animation anim = {};
+        for (animation::text_field* field : {&anim.text_percent, &anim.text_clock}) {
+            field->font = &font_;
+            field->color_a = 255;
+        }
+        anim.text_percent.pos_x = CENTER_VAL;
+        anim.text_percent.pos_y = 100;
+        anim.text_clock.pos_x = 10;
+        anim.text_clock.pos_y = -10;
+        anim.frames = frame;
+        anim.num_frames = 1;
+        anim.cur_status = BATTERY_STATUS_CHARGING;
+        anim.cur_level = 50;
+        return anim;
+    }
+
+  private:
+    std::unique_ptr<GRSurface> texture_;
+    GRFont font_;
+    std::vector<std::unique_ptr<animation::frame>> frames_;
+};
+
+// Path of |name| in the testdata directory installed next to the test binary.
+static inline std::string test_data_path(const std::string& name) {
+    return android::base::GetExecutableDirectory() + "/testdata/" + name;
+}
+
+#endif  // HEALTHD_DRAW_TEST_UTILS_H
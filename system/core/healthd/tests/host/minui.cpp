@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <minui/minui.h>
+
+#include <string.h>
+
+std::unique_ptr<GRSurface> GRSurface::Create(size_t width, size_t height, size_t row_bytes,
+                                             size_t pixel_bytes) {
+    if (width == 0 || row_bytes == 0 || height == 0 || pixel_bytes == 0) return nullptr;
+    std::unique_ptr<GRSurface> surface(new GRSurface(width, height, row_bytes, pixel_bytes));
+    size_t data_size = row_bytes * height;
+    size_t aligned = (data_size + kSurfaceDataAlignment - 1) / kSurfaceDataAlignment *
+                     kSurfaceDataAlignment;
+    surface->data_.reset(new (std::nothrow) uint8_t[aligned]());
+    if (!surface->data_) return nullptr;
+    surface->data_size_ = data_size;
+    return surface;
+}
+
+// There is no display on a host.
+int gr_init() {
+    return -1;
+}
+
+void gr_exit() {}
+
+int gr_fb_width() {
+    return 0;
+}
+
+int gr_fb_height() {
+    return 0;
+}
+
+void gr_flip() {}
+void gr_fb_blank(bool) {}
+void gr_fb_blank(bool, int) {}
+
+bool gr_has_multiple_connectors() {
+    return false;
+}
+
+void gr_clear() {}
+void gr_color(unsigned char, unsigned char, unsigned char, unsigned char) {}
+void gr_fill(int, int, int, int) {}
+void gr_texticon(int, int, const GRSurface*) {}
+
+const GRFont* gr_sys_font() {
+    return nullptr;
+}
+
+int gr_init_font(const char*, GRFont**) {
+    return -1;
+}
+
+void gr_text(const GRFont*, int, int, const char*, bool) {}
+
+int gr_measure(const GRFont* font, const char* s) {
+    if (font == nullptr) return -1;
+    return font->char_width * strlen(s);
+}
+
+void gr_blit(const GRSurface*, int, int, int, int, int, int) {}
+void gr_rotate(GRRotation) {}
+
+PixelFormat gr_pixel_format() {
+    return PixelFormat::RGBX;
+}
+
+int res_create_display_surface(const char*, GRSurface** pSurface) {
+    *pSurface = nullptr;
+    return -1;
+}
+
+int res_create_multi_display_surface(const char*, int* frames, int* fps, GRSurface*** pSurface) {
+    *frames = 0;
+    *fps = 0;
+    *pSurface = nullptr;
+    return -1;
+}
+
+void res_free_surface(GRSurface* surface) {
+    delete surface;
+}
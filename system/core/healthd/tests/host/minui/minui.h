@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Host stand-in for recovery's minui: the part of its API healthd_draw uses,
+// with the same declarations. libminui is only built for devices; on a host
+// every frame is drawn into a MemoryDrawBackend, so gr_init() always fails and
+// the drawing calls do nothing. Surfaces, fonts and gr_measure() behave as on
+// a device.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+enum class GRRotation : int {
+    NONE = 0,
+    RIGHT = 1,
+    DOWN = 2,
+    LEFT = 3,
+};
+
+enum class PixelFormat : int {
+    UNKNOWN = 0,
+    ABGR = 1,
+    RGBX = 2,
+    BGRA = 3,
+    ARGB = 4,
+};
+
+class GRSurface {
+  public:
+    static constexpr size_t kSurfaceDataAlignment = 8;
+
+    virtual ~GRSurface() = default;
+
+    // Creates and returns a GRSurface instance that's sufficient for storing an
+    // image of the given size. Returns nullptr on error.
+    static std::unique_ptr<GRSurface> Create(size_t width, size_t height, size_t row_bytes,
+                                             size_t pixel_bytes);
+
+    virtual uint8_t* data() { return data_.get(); }
+    const uint8_t* data() const { return const_cast<GRSurface*>(this)->data(); }
+    size_t data_size() const { return data_size_; }
+
+    size_t width;
+    size_t height;
+    size_t row_bytes;
+    size_t pixel_bytes;
+
+  protected:
+    GRSurface(size_t width, size_t height, size_t row_bytes, size_t pixel_bytes)
+        : width(width), height(height), row_bytes(row_bytes), pixel_bytes(pixel_bytes) {}
+
+  private:
+    std::unique_ptr<uint8_t[]> data_;
+    size_t data_size_ = 0;
+};
+
+struct GRFont {
+    GRSurface* texture;
+    int char_width;
+    int char_height;
+};
+
+int gr_init();
+void gr_exit();
+
+int gr_fb_width();
+int gr_fb_height();
+
+void gr_flip();
+void gr_fb_blank(bool blank);
+void gr_fb_blank(bool blank, int index);
+bool gr_has_multiple_connectors();
+
+void gr_clear();
+void gr_color(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+void gr_fill(int x1, int y1, int x2, int y2);
+
+void gr_texticon(int x, int y, const GRSurface* icon);
+
+const GRFont* gr_sys_font();
+int gr_init_font(const char* name, GRFont** dest);
+void gr_text(const GRFont* font, int x, int y, const char* s, bool bold);
+// Returns -1 if font is nullptr.
+int gr_measure(const GRFont* font, const char* s);
+
+void gr_blit(const GRSurface* source, int sx, int sy, int w, int h, int dx, int dy);
+
+void gr_rotate(GRRotation rotation);
+PixelFormat gr_pixel_format();
+
+int res_create_display_surface(const char* name, GRSurface** pSurface);
+int res_create_multi_display_surface(const char* name, int* frames, int* fps,
+                                     GRSurface*** pSurface);
+void res_free_surface(GRSurface* surface);
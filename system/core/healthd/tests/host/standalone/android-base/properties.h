@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+
+#include <limits>
+#include <string>
+
+namespace android {
+namespace base {
+
+// As libbase does on a host, properties live in a map of this process.
+std::string GetProperty(const std::string& key, const std::string& default_value);
+bool SetProperty(const std::string& key, const std::string& value);
+
+bool GetBoolProperty(const std::string& key, bool default_value);
+
+template <typename T>
+T GetIntProperty(const std::string& key, T default_value, T min = std::numeric_limits<T>::min(),
+                 T max = std::numeric_limits<T>::max()) {
+    std::string value = GetProperty(key, "");
+    if (value.empty()) return default_value;
+    char* end;
+    long long parsed = strtoll(value.c_str(), &end, 0);
+    if (*end != '\0' || parsed < min || parsed > max) return default_value;
+    return static_cast<T>(parsed);
+}
+
+}  // namespace base
+}  // namespace android
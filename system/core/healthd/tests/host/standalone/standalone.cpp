@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The libbase and libcutils functions healthd_draw uses, for host builds
+// outside the Android tree; an Android build links the real libraries.
+
+#include <android-base/file.h>
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+#include <cutils/klog.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <mutex>
+
+namespace android {
+namespace base {
+
+bool ReadFileToString(const std::string& path, std::string* content, bool) {
+    content->clear();
+    FILE* file = fopen(path.c_str(), "re");
+    if (file == nullptr) return false;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) content->append(buffer, n);
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+std::string GetExecutableDirectory() {
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length < 0) return ".";
+    path[length] = '\0';
+    char* slash = strrchr(path, '/');
+    return slash ? std::string(path, slash - path) : ".";
+}
+
+static std::mutex& properties_lock() {
+    static std::mutex lock;
+    return lock;
+}
+
+static std::map<std::string, std::string>& properties() {
+    static std::map<std::string, std::string> properties;
+    return properties;
+}
+
+std::string GetProperty(const std::string& key, const std::string& default_value) {
+    std::lock_guard<std::mutex> lock(properties_lock());
+    auto found = properties().find(key);
+    return found == properties().end() ? default_value : found->second;
+}
+
+bool SetProperty(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(properties_lock());
+    properties()[key] = value;
+    return true;
+}
+
+bool GetBoolProperty(const std::string& key, bool default_value) {
+    std::string value = GetProperty(key, "");
+    if (value == "1" || value == "y" || value == "yes" || value == "on" || value == "true") {
+        return true;
+    }
+    if (value == "0" || value == "n" || value == "no" || value == "off" || value == "false") {
+        return false;
+    }
+    return default_value;
+}
+
+std::string StringPrintf(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    va_list copy;
+    va_copy(copy, ap);
+    int length = vsnprintf(nullptr, 0, fmt, copy);
+    va_end(copy);
+    std::string result(length > 0 ? length : 0, '\0');
+    if (length > 0) vsnprintf(&result[0], length + 1, fmt, ap);
+    va_end(ap);
+    return result;
+}
+
+std::vector<std::string> Split(const std::string& s, const std::string& delimiters) {
+    std::vector<std::string> result;
+    size_t base = 0;
+    size_t found;
+    while ((found = s.find_first_of(delimiters, base)) != std::string::npos) {
+        result.push_back(s.substr(base, found - base));
+        base = found + 1;
+    }
+    result.push_back(s.substr(base));
+    return result;
+}
+
+std::string Trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n\f\v");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n\f\v");
+    return s.substr(start, end - start + 1);
+}
+
+bool StartsWith(const std::string& s, const char* prefix) {
+    return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+}  // namespace base
+}  // namespace android
+
+static int klog_level = KLOG_DEFAULT_LEVEL;
+
+void klog_set_level(int level) {
+    klog_level = level;
+}
+
+void klog_write(int level, const char* fmt, ...) {
+    if (level > klog_level) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Builds the glyph cache of a charger font PNG at image build time:
+//
+//   healthd_glyph_cache <font.png> <name.glyphs>
+//
+// The output is installed in /res/images/glyph_cache, named as
+// glyph_cache_path() names the font the animation description refers to. The
+// PNG must be installed byte for byte as given here, or the charger ignores
+// the cache and decodes the PNG.
+
+#include <png.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "healthd_draw_glyph_cache.h"
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <font.png> <name.glyphs>\n", argv[0]);
+        return 2;
+    }
+    const char* png_path = argv[1];
+    const char* cache_path = argv[2];
+
+    GlyphCacheSource source;
+    if (!read_glyph_cache_source(png_path, &source)) {
+        fprintf(stderr, "%s: cannot read\n", png_path);
+        return 1;
+    }
+
+    png_image image = {};
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, png_path)) {
+        fprintf(stderr, "%s: %s\n", png_path, image.message);
+        return 1;
+    }
+    // minui only makes alpha textures of grayscale PNGs.
+    if (image.format & (PNG_FORMAT_FLAG_COLOR | PNG_FORMAT_FLAG_ALPHA)) {
+        fprintf(stderr, "%s: not a grayscale PNG\n", png_path);
+        png_image_free(&image);
+        return 1;
+    }
+    image.format = PNG_FORMAT_GRAY;
+    std::vector<uint8_t> pixels(PNG_IMAGE_SIZE(image));
+    if (!png_image_finish_read(&image, nullptr, pixels.data(), 0, nullptr)) {
+        fprintf(stderr, "%s: %s\n", png_path, image.message);
+        return 1;
+    }
+
+    // As gr_init_font(): 96 glyphs across, regular above bold.
+    uint32_t char_width = image.width / 96;
+    uint32_t char_height = image.height / 2;
+    if (char_width == 0 || char_height == 0) {
+        fprintf(stderr, "%s: %ux%u is too small for a font\n", png_path, image.width,
+                image.height);
+        return 1;
+    }
+    if (!write_glyph_cache(cache_path, source, char_width, char_height, image.width, image.height,
+                           image.width, pixels.data())) {
+        fprintf(stderr, "%s: cannot write\n", cache_path);
+        return 1;
+    }
+    return 0;
+}